@@ -0,0 +1,55 @@
+/**
+ *  Allocations.h
+ *
+ *  Replaces the global operator new and delete, to count how often
+ *  memory is allocated. All memory of the library, including the
+ *  chunks of the pools, is allocated through them. This header may
+ *  only be included by a single source file of a program.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <cstdlib>
+#include <new>
+
+/**
+ *  Number of allocations so far
+ */
+static size_t allocations = 0;
+
+/**
+ *  Allocate memory, and count it
+ *
+ *  @param  size    number of bytes
+ *  @param  align   alignment of the memory
+ *  @return void*
+ */
+void *operator new(size_t size)
+{
+    ++allocations;
+    if (void *memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+void *operator new(size_t size, std::align_val_t align)
+{
+    ++allocations;
+    size_t alignment = static_cast<size_t>(align);
+    size_t rounded = size ? (size + alignment - 1) / alignment * alignment : alignment;
+    if (void *memory = std::aligned_alloc(alignment, rounded)) return memory;
+    throw std::bad_alloc();
+}
+
+/**
+ *  Release memory
+ *
+ *  @param  memory  the memory to release
+ */
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+void operator delete(void *memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void *memory, size_t, std::align_val_t) noexcept { std::free(memory); }
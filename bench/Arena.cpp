@@ -0,0 +1,55 @@
+/**
+ *  Arena.cpp
+ *
+ *  Counts the allocations per parsed document, when the document is
+ *  built on the heap and when it is built in a monotonic buffer that
+ *  is released in one step when the document is done.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueArena.h"
+#include "Allocations.h"
+#include "Timer.h"
+#include <cstdio>
+#include <memory_resource>
+#include <string>
+
+using namespace Variant;
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // a request sized document with long strings, that do not fit in a value
+    std::string json = "{\"id\":12345,\"type\":\"page_view\",\"user\":{\"name\":\"Some Person With A Long Name\",\"email\":\"some.person@example.com\","
+                       "\"tags\":[\"customer\",\"newsletter subscriber\",\"premium account holder\"]},\"items\":[";
+    for (int i = 0; i < 20; ++i) json += (i ? ",{\"sku\":\"product-sku-number-" : "{\"sku\":\"product-sku-number-") + std::to_string(i) + "\",\"price\":" + std::to_string(i * 1.25) + ",\"quantity\":" + std::to_string(i % 3 + 1) + "}";
+    json += "],\"referrer\":\"https://www.example.com/some/long/path?with=query&parameters=1\"}";
+
+    // the number of documents
+    const int rounds = 20000;
+
+    // parse the documents on the heap
+    size_t before = allocations;
+    Timer heap;
+    for (int i = 0; i < rounds; ++i) Value document = Value::fromJson(json);
+    printf("heap:  %6.1f allocations/document %6.2f us/document\n", double(allocations - before) / rounds, heap.milliseconds() * 1e3 / rounds);
+
+    // and in an arena that is released after every document
+    char buffer[64 * 1024];
+    before = allocations;
+    Timer arena;
+    for (int i = 0; i < rounds; ++i)
+    {
+        std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer));
+        ValueArena scope(&resource);
+        Value document = Value::fromJson(json);
+    }
+    printf("arena: %6.1f allocations/document %6.2f us/document\n", double(allocations - before) / rounds, arena.milliseconds() * 1e3 / rounds);
+
+    // done
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ *  Conversions.cpp
+ *
+ *  Converts strings with numbers, and strings without them, to
+ *  integers and doubles. For comparison, the same strings are also
+ *  converted with std::stoll() and std::stod(), which throw an
+ *  exception for every string that is not a number.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "Timer.h"
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Time a conversion of every value, and report the time per value
+ *
+ *  @param  name        name of the conversion
+ *  @param  values      the values to convert
+ *  @param  convert     the conversion, returns a number so that it is not optimized away
+ */
+template <typename Conversion>
+static void run(const char *name, const std::vector<Value>& values, const Conversion& convert)
+{
+    Timer timer;
+    double check = 0;
+    for (auto &value : values) check += convert(value);
+    printf("%-22s %7.1f ns/value (%g)\n", name, timer.milliseconds() * 1e6 / values.size(), check);
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // strings with integers, with floating point numbers, and without numbers
+    std::mt19937 random(1);
+    std::vector<Value> integers, doubles, words;
+    for (int i = 0; i < 1000000; ++i)
+    {
+        integers.push_back(std::to_string(random() % 1000000));
+        doubles.push_back(std::to_string(random() % 100000 / 7.0));
+        words.push_back("field" + std::to_string(i % 100));
+    }
+
+    // integers
+    run("int64 numeric", integers, [](const Value& value) { return (int64_t)value; });
+    run("int64 numeric stoll", integers, [](const Value& value) -> int64_t {
+        try { return std::stoll((std::string)value); } catch (const std::exception&) { return 0; }
+    });
+    run("int64 words", words, [](const Value& value) { return (int64_t)value; });
+    run("int64 words stoll", words, [](const Value& value) -> int64_t {
+        try { return std::stoll((std::string)value); } catch (const std::exception&) { return 0; }
+    });
+
+    // doubles
+    run("double numeric", doubles, [](const Value& value) { return (double)value; });
+    run("double numeric stod", doubles, [](const Value& value) {
+        try { return std::stod((std::string)value); } catch (const std::exception&) { return 0.0; }
+    });
+    run("double words", words, [](const Value& value) { return (double)value; });
+    run("double words stod", words, [](const Value& value) {
+        try { return std::stod((std::string)value); } catch (const std::exception&) { return 0.0; }
+    });
+
+    // and finding out whether a string holds a number at all
+    run("tryCast numeric", integers, [](const Value& value) { int64_t result; return value.tryCast(result) ? result : -1; });
+    run("tryCast words", words, [](const Value& value) { int64_t result; return value.tryCast(result) ? result : -1; });
+
+    // done
+    return 0;
+}
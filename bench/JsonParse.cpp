@@ -0,0 +1,80 @@
+/**
+ *  JsonParse.cpp
+ *
+ *  Parses documents of 2 to 50 KB with the native parser, and with
+ *  json-c followed by converting the json-c objects into values,
+ *  which is how documents used to be parsed.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Timer.h"
+#include <json-c/json.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Build a document with a number of items
+ *
+ *  @param  items   number of items
+ *  @return the document as json
+ */
+static std::string document(int items)
+{
+    Value document;
+    document["id"] = "0f8fad5b-d9cb-469f-a165-70867728950e";
+    for (int i = 0; i < items; ++i)
+    {
+        Value item;
+        item["id"] = (int64_t)i * 12345;
+        item["name"] = "item number " + std::to_string(i);
+        item["price"] = i * 1.25;
+        item["available"] = i % 2 == 0;
+        item["tags"] = std::vector<Value>{ "a", "bb", "description with \"quotes\"" };
+        document["items"][i] = std::move(item);
+    }
+    return document.toJsonString();
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // documents of about 2, 10 and 50 KB
+    for (int items : { 15, 75, 375 })
+    {
+        std::string json = document(items);
+        int rounds = 20000000 / json.size();
+        size_t check = 0;
+
+        // parse with the native parser
+        Timer native;
+        for (int i = 0; i < rounds; ++i) check += Value::fromJson(json).size();
+        double nativeMs = native.milliseconds();
+
+        // parse with json-c, and convert the result
+        Timer jsonc;
+        for (int i = 0; i < rounds; ++i)
+        {
+            auto *object = json_tokener_parse(json.c_str());
+            check += Value::fromJson(object).size();
+            json_object_put(object);
+        }
+        double jsoncMs = jsonc.milliseconds();
+
+        // report the time per document, and the throughput
+        printf("%6zu bytes: native %8.1f us %6.1f MB/s, json-c %8.1f us %6.1f MB/s, %.1fx (%zu)\n", json.size(),
+            nativeMs * 1e3 / rounds, json.size() * rounds / nativeMs / 1e3,
+            jsoncMs * 1e3 / rounds, json.size() * rounds / jsoncMs / 1e3,
+            jsoncMs / nativeMs, check);
+    }
+
+    // done
+    return 0;
+}
@@ -0,0 +1,85 @@
+/**
+ *  MissingKeys.cpp
+ *
+ *  Looks up keys that exist and keys that do not, from more and more
+ *  threads at the same time. A miss should cost no more than a hit,
+ *  and neither should get slower when threads are added. For
+ *  comparison, the same misses are also found with std::map::at(),
+ *  which throws and catches an exception for every missing key.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Timer.h"
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Run a lookup in a number of threads, and report the time per lookup
+ *
+ *  @param  name        what is looked up
+ *  @param  threads     number of threads
+ *  @param  count       number of lookups per thread
+ *  @param  lookup      the lookup, gets the number of the lookup and returns the number of values found
+ */
+template <typename Lookup>
+static void run(const char *name, int threads, int count, const Lookup& lookup)
+{
+    // start the threads
+    Timer timer;
+    std::vector<std::thread> workers;
+    std::vector<size_t> found(threads);
+    for (int t = 0; t < threads; ++t) workers.emplace_back([&lookup, &found, t, count]() {
+        for (int i = 0; i < count; ++i) found[t] += lookup(i);
+    });
+    for (auto &worker : workers) worker.join();
+
+    // report the time per lookup, in every thread
+    size_t total = 0;
+    for (auto number : found) total += number;
+    printf("%2d threads %-12s %8.1f ns/lookup (%zu found)\n", threads, name, timer.milliseconds() * 1e6 / count, total);
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // a sparse record, and keys that are in it and keys that are not
+    Value record;
+    std::map<std::string, Value> map;
+    std::vector<std::string> present, absent;
+    for (int i = 0; i < 16; ++i)
+    {
+        present.push_back("field" + std::to_string(i));
+        absent.push_back("other" + std::to_string(i));
+        record[present.back()] = i;
+        map[present.back()] = i;
+    }
+    const Value &constant = record;
+
+    // the number of lookups per thread
+    const int count = 1000000;
+
+    // run with more and more threads
+    for (int threads : { 1, 2, 4, 8, 16, 32 })
+    {
+        run("hit", threads, count, [&](int i) { return constant[present[i % 16]].type() != ValueNullType; });
+        run("miss", threads, count, [&](int i) { return constant[absent[i % 16]].type() != ValueNullType; });
+        run("miss throws", threads, count / 100, [&](int i) -> size_t {
+            try { return map.at(absent[i % 16]).type() != ValueNullType; }
+            catch (const std::out_of_range&) { return 0; }
+        });
+    }
+
+    // done
+    return 0;
+}
@@ -0,0 +1,66 @@
+/**
+ *  MsgPack.cpp
+ *
+ *  Compares the size of a document in MessagePack with its size in
+ *  json, and the time it takes to write and parse it in both formats.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Timer.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Time a workload, and report the time per round
+ *
+ *  @param  name        name of the workload
+ *  @param  rounds      number of rounds
+ *  @param  workload    the workload, returns a number so that it is not optimized away
+ */
+template <typename Workload>
+static void run(const char *name, int rounds, const Workload& workload)
+{
+    Timer timer;
+    size_t check = 0;
+    for (int i = 0; i < rounds; ++i) check += workload();
+    printf("%-16s %8.1f us (%zu)\n", name, timer.milliseconds() * 1e3 / rounds, check);
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // a document with numbers, strings, arrays and maps
+    Value document;
+    for (int i = 0; i < 200; ++i)
+    {
+        Value item;
+        item["id"] = (int64_t)i * 12345;
+        item["name"] = "item number " + std::to_string(i);
+        item["price"] = i * 1.25;
+        item["tags"] = std::vector<Value>{ "a", "bb", true };
+        document["items"][i] = std::move(item);
+    }
+
+    // the sizes in both formats
+    std::string json = document.toJsonString();
+    std::string msgpack = document.toMsgPack();
+    printf("size json %zu bytes, msgpack %zu bytes\n", json.size(), msgpack.size());
+
+    // writing and parsing both formats
+    const int rounds = 2000;
+    run("write json", rounds, [&]() { return document.toJsonString().size(); });
+    run("write msgpack", rounds, [&]() { return document.toMsgPack().size(); });
+    run("parse json", rounds, [&]() { return Value::fromJson(json).size(); });
+    run("parse msgpack", rounds, [&]() { return Value::fromMsgPack(msgpack).size(); });
+
+    // done
+    return 0;
+}
@@ -0,0 +1,89 @@
+/**
+ *  NestedFill.cpp
+ *
+ *  Fills a map of 100k entries that is nested three levels deep. A
+ *  write through operator[] modifies the nested map in place. For
+ *  comparison, the same map is also filled by copying every level,
+ *  modifying the copy and writing it back, which is what nested
+ *  writes used to do. That copies the nested map for every entry, so
+ *  it is only done for the smaller sizes.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Timer.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Fill a nested map through operator[]
+ *
+ *  @param  keys    the keys of the entries
+ *  @return Value
+ */
+static Value inPlace(const std::vector<std::string>& keys)
+{
+    Value document;
+    for (size_t i = 0; i < keys.size(); ++i) document["a"]["b"][keys[i]] = (int64_t)i;
+    return document;
+}
+
+/**
+ *  Fill a nested map by copying every level and writing it back
+ *
+ *  @param  keys    the keys of the entries
+ *  @return Value
+ */
+static Value copying(const std::vector<std::string>& keys)
+{
+    Value document;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        // copy the levels, the copies share their data with the document until they are modified
+        const Value &constant = document;
+        Value a = constant["a"];
+        Value b = static_cast<const Value&>(a)["b"];
+
+        // modify the copies, and write them back
+        b[keys[i]] = (int64_t)i;
+        a["b"] = b;
+        document["a"] = a;
+    }
+    return document;
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // fill maps of increasing size
+    for (size_t size : { 1000, 10000, 100000 })
+    {
+        // the keys of the entries
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < size; ++i) keys.push_back("key" + std::to_string(i));
+
+        // fill the map in place
+        Timer timer;
+        Value filled = inPlace(keys);
+        double ms = timer.milliseconds();
+        printf("%6zu entries in place: %9.1f ms %8.1f ns/entry\n", size, ms, ms * 1e6 / size);
+
+        // and by copying, which grows with the square of the size
+        if (size > 10000) continue;
+        Timer copyTimer;
+        Value copied = copying(keys);
+        ms = copyTimer.milliseconds();
+        printf("%6zu entries copying:  %9.1f ms %8.1f ns/entry\n", size, ms, ms * 1e6 / size);
+        if (copied != filled) printf("the maps are not the same\n");
+    }
+
+    // done
+    return 0;
+}
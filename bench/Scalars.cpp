@@ -0,0 +1,92 @@
+/**
+ *  Scalars.cpp
+ *
+ *  Constructs, assigns, copies and reads null, boolean, integer and
+ *  floating point values. These are stored in the Value itself, so
+ *  none of this should allocate any memory.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "Allocations.h"
+#include "Timer.h"
+#include <cstdio>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Run a workload, and report the time and the allocations per value
+ *
+ *  @param  name        name of the workload
+ *  @param  count       number of values in the workload
+ *  @param  workload    the workload, returns a number so that it is not optimized away
+ */
+template <typename Workload>
+static void run(const char *name, size_t count, const Workload& workload)
+{
+    size_t before = allocations;
+    Timer timer;
+    int64_t result = workload();
+    double ms = timer.milliseconds();
+    printf("%-12s %6.2f ns/value %6.3f allocations/value (%lld)\n", name, ms * 1e6 / count, double(allocations - before) / count, (long long)result);
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // the number of values, and the values themselves
+    const size_t count = 10000000;
+    std::vector<Value> values(1024);
+
+    // construct values of every scalar type
+    run("construct", count, [&]() {
+        int64_t sum = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            Value value = i % 5 == 0 ? Value() : i % 5 == 1 ? Value(i % 2 == 0) : i % 5 == 2 ? Value((int32_t)i) : i % 5 == 3 ? Value((int64_t)i) : Value(i * 0.5);
+            sum += value.type();
+        }
+        return sum;
+    });
+
+    // assign them to existing values
+    run("assign", count, [&]() {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Value &value = values[i % values.size()];
+            switch (i % 4)
+            {
+                case 0: value = (int32_t)i; break;
+                case 1: value = (int64_t)i; break;
+                case 2: value = i * 0.5; break;
+                default: value = Value(); break;
+            }
+        }
+        return (int64_t)values.size();
+    });
+
+    // copy them
+    run("copy", count, [&]() {
+        int64_t sum = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            Value copy = values[i % values.size()];
+            sum += copy.type();
+        }
+        return sum;
+    });
+
+    // and read them
+    run("read", count, [&]() {
+        int64_t sum = 0;
+        for (size_t i = 0; i < count; ++i) sum += (int64_t)values[i % values.size()];
+        return sum;
+    });
+
+    // done
+    return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ *  ThreadScaling.cpp
+ *
+ *  Creates and destructs strings, vectors and maps from 1 up to 64
+ *  threads at the same time. Every thread also hands a share of its
+ *  values to a neighbour, so that memory is released by another thread
+ *  than the one that allocated it. With per-thread pools the time per
+ *  document should stay flat as threads are added.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "Timer.h"
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // the total number of documents, divided over the threads
+    const int total = 400000;
+
+    // run with more and more threads
+    for (int threads : { 1, 2, 4, 8, 16, 32, 64 })
+    {
+        // the values that every thread keeps for its neighbour
+        std::vector<std::vector<Value>> handoff(threads);
+        Timer timer;
+
+        // every thread builds and drops small documents
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) workers.emplace_back([&handoff, t, threads, total]() {
+            int count = total / threads;
+            auto &kept = handoff[t];
+            kept.reserve(count / 8 + 1);
+            for (int i = 0; i < count; ++i)
+            {
+                Value value(std::vector<Value>{ Value("some string value"), Value(std::map<std::string, Value>{ { "k", Value("v") } }) });
+                if (i % 8 == 0) kept.push_back(std::move(value));
+            }
+        });
+        for (auto &worker : workers) worker.join();
+
+        // and destructs the values that its neighbour kept
+        std::vector<std::thread> droppers;
+        for (int t = 0; t < threads; ++t) droppers.emplace_back([&handoff, t, threads]() { handoff[(t + 1) % threads].clear(); });
+        for (auto &dropper : droppers) dropper.join();
+
+        // report the time per document
+        double ms = timer.milliseconds();
+        printf("%2d threads: %8.1f ms %8.1f ns/document\n", threads, ms, ms * 1e6 / total);
+    }
+
+    // done
+    return 0;
+}
@@ -0,0 +1,38 @@
+/**
+ *  Timer.h
+ *
+ *  Measures the time that has passed since it was constructed, for
+ *  the benchmark programs.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <chrono>
+
+/**
+ *  Class definition
+ */
+class Timer
+{
+private:
+    /**
+     *  When the timer was started
+     */
+    std::chrono::steady_clock::time_point _start = std::chrono::steady_clock::now();
+
+public:
+    /**
+     *  Number of milliseconds since the timer was started
+     *
+     *  @return double
+     */
+    double milliseconds() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+    }
+};
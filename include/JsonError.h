@@ -0,0 +1,48 @@
+/**
+ *  JsonError.h
+ *
+ *  Information about a json document that
+ *  could not be parsed.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <cstddef>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Class definition
+ */
+struct JsonError
+{
+    /**
+     *  Offset in the input at which the error was found
+     *  @var    size_t
+     */
+    size_t offset = 0;
+
+    /**
+     *  Description of the error, or a nullptr if there was no error
+     *  @var    const char *
+     */
+    const char *reason = nullptr;
+
+    /**
+     *  Did an error occur?
+     */
+    explicit operator bool () const { return reason != nullptr; }
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -0,0 +1,103 @@
+/**
+ *  JsonHandler.h
+ *
+ *  Interface for receiving the contents of a json document
+ *  as a series of events, without building Value objects
+ *  for the parts of the document that are not needed.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+// forward declaration
+class Value;
+
+/**
+ *  What to do with the value of an object member or array item
+ */
+typedef enum _JsonActions {
+    JsonVisit,      // report the value through events
+    JsonSkip,       // skip the value, no events are reported
+    JsonCapture,    // build a Value and pass it to onValue()
+    JsonStop        // stop parsing the document
+} JsonAction;
+
+/**
+ *  Class definition
+ *
+ *  Every event method returns whether parsing should go on,
+ *  returning false stops the parser. The string views passed
+ *  to the events are only valid during the call.
+ */
+class JsonHandler
+{
+public:
+    /**
+     *  Destructor
+     */
+    virtual ~JsonHandler() {}
+
+    /**
+     *  Scalar values
+     */
+    virtual bool onNull() { return true; }
+    virtual bool onBool(bool value) { return true; }
+    virtual bool onInteger(int64_t value) { return true; }
+    virtual bool onDouble(double value) { return true; }
+    virtual bool onString(std::string_view value) { return true; }
+
+    /**
+     *  Start and end of an object
+     */
+    virtual bool onStartObject() { return true; }
+    virtual bool onEndObject() { return true; }
+
+    /**
+     *  The key of an object member, the returned action
+     *  decides what happens with the value that follows
+     *
+     *  @param  key
+     *  @return JsonAction
+     */
+    virtual JsonAction onKey(std::string_view key) { return JsonVisit; }
+
+    /**
+     *  Start and end of an array
+     */
+    virtual bool onStartArray() { return true; }
+    virtual bool onEndArray() { return true; }
+
+    /**
+     *  The start of an array item, the returned action
+     *  decides what happens with the item
+     *
+     *  @param  index
+     *  @return JsonAction
+     */
+    virtual JsonAction onItem(size_t index) { return JsonVisit; }
+
+    /**
+     *  A value for which onKey() or onItem() returned JsonCapture
+     *
+     *  @param  value
+     */
+    virtual bool onValue(Value&& value) { return true; }
+};
+
+/**
+ *  End namespace
+ */
+}
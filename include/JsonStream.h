@@ -0,0 +1,144 @@
+/**
+ *  JsonStream.h
+ *
+ *  Push parser for a stream of json documents, like newline
+ *  delimited json. The input can be fed in chunks of any size,
+ *  and every document is reported as soon as it is complete.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include "Value.h"
+#include "JsonError.h"
+#include <functional>
+#include <string>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Class definition
+ */
+class JsonStream
+{
+public:
+    /**
+     *  Type of the callback that receives the documents
+     */
+    using Callback = std::function<void(Value&& value)>;
+
+private:
+    /**
+     *  The callback to report documents to
+     *  @var    Callback
+     */
+    Callback _callback;
+
+    /**
+     *  The start of a document that is not yet complete,
+     *  kept over from previous chunks
+     *  @var    std::string
+     */
+    std::string _buffer;
+
+    /**
+     *  The number of bytes processed before the current chunk
+     *  @var    size_t
+     */
+    size_t _processed = 0;
+
+    /**
+     *  Offset in the stream where the current document started
+     *  @var    size_t
+     */
+    size_t _start = 0;
+
+    /**
+     *  Nesting depth inside the current document
+     *  @var    size_t
+     */
+    size_t _depth = 0;
+
+    /**
+     *  Are we inside a string, right after a backslash,
+     *  or inside a document that is not a container?
+     */
+    bool _string = false;
+    bool _escaped = false;
+    bool _scalar = false;
+
+    /**
+     *  The last error that occured
+     *  @var    JsonError
+     */
+    JsonError _error;
+
+    /**
+     *  Parse a complete document and report it
+     *
+     *  @param  data    start of the document
+     *  @param  size    size of the document
+     *  @param  offset  offset of the document in the stream
+     *  @return was the document valid?
+     */
+    bool emit(const char *data, size_t size, size_t offset);
+
+    /**
+     *  Complete the current document
+     *
+     *  @param  start   start of the document in the current chunk
+     *  @param  end     end of the document
+     *  @return was the document valid?
+     */
+    bool complete(const char *start, const char *end);
+
+public:
+    /**
+     *  Constructor
+     *
+     *  @param  callback    called for every complete document
+     */
+    JsonStream(const Callback& callback) : _callback(callback) {}
+
+    /**
+     *  Feed the next chunk of input
+     *
+     *  All documents that are completed by this chunk are passed
+     *  to the callback right away. Invalid documents are skipped,
+     *  and reported through the return value and the error.
+     *
+     *  @param  data    the input
+     *  @param  size    size of the input
+     *  @return were all completed documents valid?
+     */
+    bool parse(const char *data, size_t size);
+
+    /**
+     *  Signal the end of the input, a final document that
+     *  was not followed by anything (like a number without
+     *  a trailing newline) is reported now
+     *
+     *  @return was the input valid and complete?
+     */
+    bool finish();
+
+    /**
+     *  The last error, the offset is counted from
+     *  the very start of the stream
+     *
+     *  @return JsonError
+     */
+    const JsonError& error() const { return _error; }
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -0,0 +1,60 @@
+/**
+ *  KeyTable.h
+ *
+ *  Process wide table of map keys. When it is enabled, maps do not
+ *  store their own copy of keys that are too long to be stored inline,
+ *  but share the copy in the table. Maps with the same keys then use
+ *  less memory, and their keys can be compared by address.
+ *
+ *  Keys are never removed from the table, so it is meant for the
+ *  field names of documents, not for keys that are data themselves.
+ *  The limit makes sure the table does not grow without bounds, keys
+ *  that do not fit are simply stored in the map.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <string_view>
+#include <cstddef>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Class definition
+ */
+class KeyTable
+{
+public:
+    /**
+     *  Start sharing keys
+     *
+     *  @param  limit   maximum number of keys in the table
+     */
+    static void enable(size_t limit = 65536);
+
+    /**
+     *  Stop sharing keys, the keys that are already shared stay valid
+     */
+    static void disable();
+
+    /**
+     *  Find or add a key
+     *
+     *  @param  key     the key to look up
+     *  @return the shared copy of the key, or a nullptr if keys are not shared
+     */
+    static const char *intern(std::string_view key);
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -13,6 +13,11 @@
 #pragma once
 
 #include "ValueImpl.h"
+#include "JsonError.h"
+#include "JsonHandler.h"
+#include "ValueIterator.h"
+#include <string_view>
+#include <functional>
 #include <string>
 #include <vector>
 #include <map>
@@ -22,9 +27,11 @@
  */
 namespace Variant {
 
-// forward declaration
+// forward declarations
 template <typename T>
 class ValueMember;
+class SnapshotWriter;
+class ValuePath;
 
 /**
  *  Class definition
@@ -33,17 +40,78 @@ class Value
 {
 private:
     /**
-     *  Typedef for the variant implementation pointer
+     *  The snapshot writer stores scalars straight from the union
      */
-    using ValueImplPtr = std::unique_ptr<ValueImpl>;
+    friend class SnapshotWriter;
 
     /**
-     *  The actual implementation
-     *  @var    impl
+     *  Paths add the values they point to, just like operator[] does
      */
-    ValueImplPtr _impl;
+    friend class ValuePath;
+
+    /**
+     *  Members modify the container they are part of
+     */
+    template <typename> friend class ValueMember;
+
+    /**
+     *  The type of value we are holding
+     *  @var    ValueType
+     */
+    ValueType _type;
+
+    /**
+     *  The actual value
+     *
+     *  Scalar values are stored inline, only strings,
+     *  vectors and maps need a separate implementation
+     */
+    union
+    {
+        bool _bool;
+        int32_t _int32;
+        int64_t _int64;
+        double _double;
+        ValueImpl *_impl;
+    };
+
+    /**
+     *  Release the implementation, if we have one
+     */
+    void release() noexcept;
+
+    /**
+     *  Take over the value held by another object,
+     *  leaving the other object as a null value
+     *
+     *  @param  that
+     */
+    void steal(Value& that) noexcept;
+
+    /**
+     *  Make sure we have a private copy of the implementation,
+     *  this must be called before the implementation is modified
+     */
+    void detach();
+
+    /**
+     *  Prepare the value to have one of its members modified
+     *
+     *  The value is turned into a container of the given type if
+     *  it is not one already, and it gets a private copy of its
+     *  implementation if that is shared.
+     *
+     *  @param  type    ValueVectorType or ValueMapType
+     *  @return the implementation to modify
+     */
+    ValueImpl *container(ValueType type);
 
 public:
+    /**
+     *  A compiled path into a document, see ValuePath.h
+     */
+    using Path = ValuePath;
+
     /**
      *  Copy constructor
      */
@@ -52,7 +120,12 @@ public:
     /**
      *  Move constructor
      */
-    Value(Value&& that);
+    Value(Value&& that) noexcept;
+
+    /**
+     *  Destructor
+     */
+    ~Value();
 
     /**
      *  Null constructor
@@ -81,6 +154,7 @@ public:
     Value(const char* value, size_t length);
     Value(const std::string& value);
     Value(std::string&& value);
+    Value(std::string_view value);
 
     /**
      *  Vector constructor
@@ -98,11 +172,106 @@ public:
     Value(std::map<std::string, Value>&& value);
     Value(const std::initializer_list<std::map<std::string, Value>::value_type>& value);
 
+    /**
+     *  Implementation constructor
+     *
+     *  The value takes ownership of the implementation,
+     *  this is used when building values from serialized data
+     *
+     *  @param  impl
+     */
+    explicit Value(ValueImpl* impl);
+
     /**
      *  Deserialize a json string into a Value
      *  Returns a null Value in case of any errors
      */
-    static Value fromJson(const std::string& json);
+    static Value fromJson(std::string_view json);
+
+    /**
+     *  Deserialize a json string into a Value, and report errors
+     *
+     *  When the json is invalid, a null Value is returned and the
+     *  error is filled with the offset and reason of the failure.
+     *  On success the error is cleared, so a parsed null can be
+     *  told apart from a parse failure.
+     */
+    static Value fromJson(std::string_view json, JsonError& error);
+
+    /**
+     *  Deserialize a json string into a Value that is decoded on demand
+     *
+     *  The json is checked right away, but objects and arrays are only
+     *  decoded when they are accessed, and then one level at a time. As
+     *  long as an object or array is not modified, serializing it copies
+     *  the original json text. Returns a null Value for invalid json.
+     */
+    static Value fromJsonLazy(std::string json);
+    static Value fromJsonLazy(std::string json, JsonError& error);
+
+    /**
+     *  Deserialize MessagePack data into a Value
+     *
+     *  Returns a null Value for invalid data, and fills the error
+     *  in the same way as fromJson() when it is given.
+     */
+    static Value fromMsgPack(std::string_view data);
+    static Value fromMsgPack(std::string_view data, JsonError& error);
+
+    /**
+     *  Deserialize CBOR data into a Value
+     *
+     *  Returns a null Value for invalid data, and fills the error
+     *  in the same way as fromJson() when it is given. Tags are
+     *  ignored, and byte strings become strings.
+     */
+    static Value fromCbor(std::string_view data);
+    static Value fromCbor(std::string_view data, JsonError& error);
+
+    /**
+     *  Deserialize CBOR data into a Value, without copying the strings
+     *
+     *  The strings in the result refer to the bytes in the data, so the
+     *  data must stay valid for as long as the Value, or any copy of it,
+     *  is used. Map keys and strings split into chunks are still copied.
+     */
+    static Value fromCborView(std::string_view data);
+    static Value fromCborView(std::string_view data, JsonError& error);
+
+    /**
+     *  Read a Value from a binary snapshot, without decoding it
+     *
+     *  Objects and arrays are read in place when they are accessed,
+     *  and strings refer to the snapshot. The data must stay valid
+     *  for as long as the Value, or any copy of it, is used. A null
+     *  Value is returned if the data is not a snapshot, or if it is
+     *  not aligned to eight bytes.
+     */
+    static Value fromSnapshot(std::string_view data);
+
+    /**
+     *  Map a snapshot file into memory and read a Value from it
+     *
+     *  The file stays mapped until the Value, and all values taken
+     *  from it, are destructed. Processes that map the same file
+     *  share its memory. A null Value is returned on failure.
+     */
+    static Value fromSnapshotFile(const char *filename);
+
+    /**
+     *  Parse a json string and report its contents to a handler
+     *
+     *  Only the values the handler captures are turned into Value
+     *  objects. Returns false when the json is invalid, but true
+     *  when the handler stopped the parser early.
+     */
+    static bool parseJson(std::string_view json, JsonHandler& handler);
+    static bool parseJson(std::string_view json, JsonHandler& handler, JsonError& error);
+
+    /**
+     *  Convert a json-c object into a Value
+     */
+    static Value fromJson(struct json_object *json);
 
     /**
      *  Get the type of value we are
@@ -114,7 +283,22 @@ public:
      *  @param  value
      */
     Value& operator=(const Value& value);
-    Value& operator=(Value&& value);
+    Value& operator=(Value&& value) noexcept;
+
+    /**
+     *  Swap two values, without touching the reference counts
+     *
+     *  This makes sorting vectors of values cheaper
+     *
+     *  @param  that
+     */
+    void swap(Value& that) noexcept
+    {
+        // every member of the union fits in the 64-bit integer, so that is all we need to exchange
+        std::swap(_type, that._type);
+        std::swap(_int64, that._int64);
+    }
+    friend void swap(Value& a, Value& b) noexcept { a.swap(b); }
 
     /**
      *  Boolean casting and assignment
@@ -132,6 +316,23 @@ public:
     Value& operator=(int64_t value);
     Value& operator=(double value);
 
+    /**
+     *  Convert to a number, but only if the value really holds one
+     *
+     *  Booleans and numbers are converted when the number fits in the
+     *  type, doubles are only converted to integers when they have no
+     *  fraction. Strings are converted when they hold nothing but a
+     *  number, whitespace around it is allowed. Null, vectors and maps
+     *  are never converted. The result is left alone when the
+     *  conversion fails.
+     *
+     *  @param  result
+     *  @return was the value converted?
+     */
+    bool tryCast(int32_t& result) const;
+    bool tryCast(int64_t& result) const;
+    bool tryCast(double& result) const;
+
     /**
      *  String casting and assignment
      */
@@ -139,6 +340,15 @@ public:
     Value& operator=(const char* value);
     Value& operator=(const std::string& value);
     Value& operator=(std::string&& value);
+    Value& operator=(std::string_view value);
+
+    /**
+     *  The bytes of a string, without copying them
+     *
+     *  The view is valid until this value is modified. Values
+     *  that are not strings return an empty view.
+     */
+    std::string_view view() const;
 
     /**
      *  Get the number of elements in the variant
@@ -154,36 +364,157 @@ public:
     struct json_object *toJson() const;
     std::string toJsonString() const;
 
+    /**
+     *  Append the value to a json string, the string can be
+     *  reused for multiple values to prevent reallocations
+     *
+     *  @param  output
+     */
+    void toJsonString(std::string& output) const;
+
+    /**
+     *  Serialize the value to MessagePack
+     *
+     *  The output can be appended to an existing buffer. Integers keep
+     *  their size: 32 bit integers use the most compact format that
+     *  fits, 64 bit integers always use the 64 bit format.
+     *
+     *  @param  output
+     */
+    std::string toMsgPack() const;
+    void toMsgPack(std::string& output) const;
+
+    /**
+     *  Serialize the value to CBOR
+     *
+     *  The output can be appended to an existing buffer. Just like
+     *  with MessagePack, 64 bit integers always use an eight byte
+     *  argument, so they are decoded as 64 bit integers again.
+     *
+     *  @param  output
+     */
+    std::string toCbor() const;
+    void toCbor(std::string& output) const;
+
+    /**
+     *  Serialize the value to a binary snapshot
+     *
+     *  The snapshot can be read back in place with fromSnapshot()
+     *  or fromSnapshotFile(), on a machine with the same byte order.
+     *  Strings and containers can hold up to 2^32-1 bytes or elements,
+     *  an empty string is returned for values that hold more.
+     */
+    std::string toSnapshot() const;
+
     /**
      *  Array casting, assignment and access
+     *
+     *  A member only refers to this value. Nothing is modified,
+     *  and no copy is made of a shared implementation, until
+     *  something is assigned to the member.
      */
     operator std::vector<Value> () const;
     Value& operator=(const std::initializer_list<Value>& value);
     Value& operator=(const std::vector<Value>& value);
     Value& operator=(std::vector<Value>&& value);
-    Value operator [] (int index) const;
+    const Value& operator [] (int index) const;
     ValueMember<int> operator [] (int index);
 
     /**
      *  Array casting, assignment and access
+     *
+     *  Members that are accessed with a string_view key refer
+     *  to the key, so they must not outlive it. The other keys
+     *  are copied into the member.
      */
     operator std::map<std::string, Value> () const;
     Value& operator=(const std::initializer_list<std::map<std::string, Value>::value_type>& value);
     Value& operator=(const std::map<std::string, Value>& value);
     Value& operator=(std::map<std::string, Value>&& value);
-    const Value operator [] (const char* key) const;
-    const Value operator [] (const std::string& key) const;
+    const Value& operator [] (const char* key) const;
+    const Value& operator [] (const std::string& key) const;
+    const Value& operator [] (std::string_view key) const;
     ValueMember<std::string> operator [] (const char* key);
     ValueMember<std::string> operator [] (const std::string& key);
+    ValueMember<std::string_view> operator [] (std::string_view key);
+
+    /**
+     *  Look up an element without copying it
+     *
+     *  A pointer to the element at the given index or key is
+     *  returned, or a nullptr if there is no such element. The
+     *  pointer is valid until this value is modified.
+     */
+    const Value* find(int index) const;
+    const Value* find(const char* key) const;
+    const Value* find(const std::string& key) const;
+    const Value* find(std::string_view key) const;
+
+    /**
+     *  Iterate over the items of a vector or the members of a map
+     *
+     *  The elements are exposed by reference, in insertion order for
+     *  maps. Other values have no elements. The iterators are valid
+     *  until this value is modified.
+     */
+    ValueIterator begin() const;
+    ValueIterator end() const;
 
     /**
      *  Equals and not equals to operators
+     *
+     *  Unlike for a double, not-a-number is equal to not-a-number,
+     *  so that every value is equal to itself, and the comparison
+     *  agrees with the ordering operators and with hash().
      */
     bool operator==(const Value &that) const;
     bool operator!=(const Value &that) const { return !(*this == that); }
+
+    /**
+     *  Ordering operators
+     *
+     *  Null goes first, followed by booleans, numbers, strings, vectors
+     *  and maps. Numbers are ordered by their value, and numbers with
+     *  the same value but a different type by their type, so that only
+     *  equal values are equivalent. Not-a-number goes after all other
+     *  numbers. Strings are compared bytewise and vectors item by item.
+     *  Smaller maps go first, maps of the same size are compared member
+     *  by member, in the order of their keys.
+     *
+     *  @param  that
+     *  @return negative when smaller, zero when equivalent, positive when bigger
+     */
+    int compare(const Value &that) const;
+    bool operator<(const Value &that) const { return compare(that) < 0; }
+    bool operator>(const Value &that) const { return compare(that) > 0; }
+    bool operator<=(const Value &that) const { return compare(that) <= 0; }
+    bool operator>=(const Value &that) const { return compare(that) >= 0; }
+
+    /**
+     *  Calculate the structural hash
+     *
+     *  Values that compare equal have the same hash. The member
+     *  order of maps does not matter, the type of numbers does.
+     *
+     *  @param  seed
+     *  @return uint64_t
+     */
+    uint64_t hash(uint64_t seed = 0) const;
 };
 
 /**
  *  End namespace
  */
-}
\ No newline at end of file
+}
+
+/**
+ *  Values can be used as keys in unordered containers
+ */
+template <>
+struct std::hash<Variant::Value>
+{
+    size_t operator()(const Variant::Value &value) const
+    {
+        return value.hash();
+    }
+};
\ No newline at end of file
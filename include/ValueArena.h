@@ -0,0 +1,97 @@
+/**
+ *  ValueArena.h
+ *
+ *  While an arena is active, the strings, vectors and maps that
+ *  are created on the same thread get their memory from a memory
+ *  resource supplied by the caller, for example a monotonic buffer
+ *  that is released in one step when a request is done.
+ *
+ *  Copies that are made when a shared value is modified, and
+ *  containers of lazy documents and snapshots, are allocated
+ *  where the value they come from lives, no matter which arena
+ *  is active. The values that are created in an arena, and all
+ *  copies of them, must be destructed before the memory resource.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <memory_resource>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Class definition
+ */
+class ValueArena
+{
+private:
+    /**
+     *  The arena that is active on this thread
+     *  @var    std::pmr::memory_resource
+     */
+    static inline thread_local std::pmr::memory_resource *_active = nullptr;
+
+    /**
+     *  The arena that was active before this one
+     *  @var    std::pmr::memory_resource
+     */
+    std::pmr::memory_resource *_previous;
+
+public:
+    /**
+     *  Constructor, activates the arena on this thread
+     *
+     *  @param  resource    the memory resource to allocate from, or a nullptr for the heap
+     */
+    ValueArena(std::pmr::memory_resource *resource) : _previous(_active)
+    {
+        _active = resource;
+    }
+
+    /**
+     *  Arenas are bound to the scope they are created in
+     */
+    ValueArena(const ValueArena& that) = delete;
+    ValueArena& operator=(const ValueArena& that) = delete;
+
+    /**
+     *  Destructor, activates the previous arena again
+     */
+    ~ValueArena()
+    {
+        _active = _previous;
+    }
+
+    /**
+     *  The arena that is active on this thread
+     *
+     *  @return the memory resource, or a nullptr when no arena is active
+     */
+    static std::pmr::memory_resource *active()
+    {
+        return _active;
+    }
+
+    /**
+     *  The memory resource to allocate from on this thread
+     *
+     *  @return the active arena, or the default resource
+     */
+    static std::pmr::memory_resource *resource()
+    {
+        return _active ? _active : std::pmr::get_default_resource();
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
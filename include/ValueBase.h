@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include <string_view>
 #include <string>
 
 /**
@@ -26,38 +27,38 @@ class ValueBase
 {
 public:
     /**
-     *  Retrieve value at the given offset
+     *  Look up the value at the given offset
      *
      *  This is only applicable for array values,
-     *  so it returns a null value by default.
+     *  so it returns a nullptr by default.
      */
-    virtual Value get(size_t index) const = 0;
+    virtual const Value* find(size_t index) const = 0;
 
     /**
-     *  Set value at the given offset
+     *  Retrieve a modifiable value at the given offset,
+     *  the value is created if it does not yet exist
      *
      *  This is only applicable for array values,
-     *  other implementation will ignore this.
+     *  for other implementations changes are ignored.
      */
-    virtual ValueBase& set(size_t index, const Value& value) = 0;
-    virtual ValueBase& set(size_t index, Value&& value) = 0;
+    virtual Value& member(size_t index) = 0;
 
     /**
-     *  Retrieve value at the given key
+     *  Look up the value at the given key
      *
-     *  This is only applicable for map values
-     *  so it returns a null value by default.
+     *  This is only applicable for map values,
+     *  so it returns a nullptr by default.
      */
-    virtual Value get(const std::string& key) const = 0;
+    virtual const Value* find(std::string_view key) const = 0;
 
     /**
-     *  Set value at the given key
+     *  Retrieve a modifiable value at the given key,
+     *  the value is created if it does not yet exist
      *
      *  This is only applicable for map values,
-     *  other implementation will ignore this.
+     *  for other implementations changes are ignored.
      */
-    virtual ValueBase& set(const std::string& key, const Value& value) = 0;
-    virtual ValueBase& set(const std::string& key, Value&& value) = 0;
+    virtual Value& member(std::string_view key) = 0;
 };
 
 /**
@@ -12,6 +12,12 @@
 #pragma once
 
 #include "ValueBase.h"
+#include "ValueArena.h"
+#include <string_view>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 #include <memory>
 #include <vector>
 #include <map>
@@ -23,6 +29,10 @@
  */
 namespace Variant {
 
+// forward declarations
+class SnapshotWriter;
+struct SnapshotSlot;
+
 /**
  *  The available value types
  */
@@ -42,12 +52,167 @@ typedef enum _ValueTypes {
  */
 class ValueImpl : public ValueBase
 {
+private:
+    /**
+     *  The number of values sharing this implementation
+     *  @var    std::atomic<uint32_t>
+     */
+    std::atomic<uint32_t> _refcount;
+
+    /**
+     *  Was the implementation allocated in an arena?
+     *  @var    bool
+     */
+    bool _arena = false;
+
+    /**
+     *  What is stored in front of an implementation allocated in an arena
+     */
+    struct alignas(std::max_align_t) ArenaHeader
+    {
+        std::pmr::memory_resource *resource;
+        size_t size;
+    };
+
+    /**
+     *  Destruct an implementation allocated in an arena,
+     *  and give the memory back to the arena
+     */
+    void destroy()
+    {
+        // the header tells us how the memory was allocated
+        auto *header = reinterpret_cast<ArenaHeader *>(this) - 1;
+        auto *resource = header->resource;
+        size_t size = header->size;
+
+        // destruct and deallocate
+        this->~ValueImpl();
+        resource->deallocate(header, size, alignof(ArenaHeader));
+    }
+
 public:
+    /**
+     *  Constructor
+     */
+    ValueImpl() : _refcount(1) {}
+
+    /**
+     *  Copy constructor
+     *
+     *  The copy is a new implementation, that is
+     *  not yet shared with any other value
+     */
+    ValueImpl(const ValueImpl& that) : _refcount(1) {}
+
     /**
      *  Destructor
      */
     virtual ~ValueImpl() {}
 
+    /**
+     *  Implementations on the heap come from a pool of the thread
+     *  that creates them, and may be deleted by any thread
+     *
+     *  @param  size        size of the implementation
+     *  @param  pointer     the implementation
+     */
+    static void *operator new(size_t size);
+    static void operator delete(void *pointer, size_t size);
+
+    /**
+     *  Implementations in an arena are constructed in place
+     *
+     *  @param  size        size of the implementation
+     *  @param  place       where to construct it
+     */
+    static void *operator new(size_t size, void *place) noexcept { return place; }
+    static void operator delete(void *pointer, void *place) noexcept {}
+
+    /**
+     *  Create a new implementation
+     *
+     *  When an arena is active on this thread, the implementation
+     *  is allocated in it, and otherwise on the heap.
+     *
+     *  @param  args    the constructor arguments
+     *  @return the new implementation
+     */
+    template <typename T, typename... Args>
+    static T *create(Args&&... args)
+    {
+        // without an arena we use the heap
+        auto *resource = ValueArena::active();
+        if (resource == nullptr) return new T(std::forward<Args>(args)...);
+
+        // allocate room for the header and the implementation
+        size_t size = sizeof(ArenaHeader) + sizeof(T);
+        auto *header = static_cast<ArenaHeader *>(resource->allocate(size, alignof(ArenaHeader)));
+        header->resource = resource;
+        header->size = size;
+
+        // construct the implementation right after the header
+        T *result;
+        try
+        {
+            result = new (header + 1) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            resource->deallocate(header, size, alignof(ArenaHeader));
+            throw;
+        }
+
+        // remember how it was allocated
+        result->_arena = true;
+        return result;
+    }
+
+    /**
+     *  The arena the implementation was allocated in
+     *
+     *  @return the memory resource, or a nullptr for the heap
+     */
+    std::pmr::memory_resource *arena() const
+    {
+        return _arena ? (reinterpret_cast<const ArenaHeader *>(this) - 1)->resource : nullptr;
+    }
+
+    /**
+     *  Share the implementation with another value
+     *
+     *  @return this
+     */
+    ValueImpl* share()
+    {
+        _refcount.fetch_add(1, std::memory_order_relaxed);
+        return this;
+    }
+
+    /**
+     *  Stop sharing the implementation, it is
+     *  destructed when no other value uses it
+     */
+    void release()
+    {
+        // nothing to do while other values use it
+        if (_refcount.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+        // give the memory back to where it came from
+        if (_arena) destroy();
+        else delete this;
+    }
+
+    /**
+     *  Is the implementation used by more than one value?
+     *
+     *  A shared implementation must be cloned
+     *  before it can be modified.
+     */
+    bool shared() const
+    {
+        return _refcount.load(std::memory_order_acquire) > 1;
+    }
+
     /**
      *  Get the implementation type
      */
@@ -70,11 +235,33 @@ public:
     virtual operator int64_t () const;
     virtual operator double () const;
 
+    /**
+     *  Convert the value to a number, if it holds nothing but a number
+     *
+     *  This is only relevant for string values, for other
+     *  implementations it fails by default. The result
+     *  is left alone when the conversion fails.
+     *
+     *  @param  result
+     *  @return was the value converted?
+     */
+    virtual bool tryCast(int32_t& result) const;
+    virtual bool tryCast(int64_t& result) const;
+    virtual bool tryCast(double& result) const;
+
     /**
      *  Convert the value to a string
      */
     virtual operator std::string () const;
 
+    /**
+     *  The bytes of a string value, without copying them
+     *
+     *  This is only relevant for string values,
+     *  it will return an empty view by default.
+     */
+    virtual std::string_view view() const;
+
     /**
      *  Convert the value to a vector
      *
@@ -101,48 +288,112 @@ public:
     virtual size_t size() const;
 
     /**
-     *  Retrieve value at the given offset
+     *  Look up the value at the given offset
      *
-     *  This is only applicable for array value,
-     *  so it returns a null value by default.
+     *  This is only applicable for array values,
+     *  so it returns a nullptr by default.
      */
-    virtual Value get(size_t index) const;
+    virtual const Value* find(size_t index) const;
 
     /**
-     *  Set value at the given offset
+     *  Retrieve a modifiable value at the given offset,
+     *  the value is created if it does not yet exist
      *
      *  This is only applicable for array values,
-     *  other implementation will ignore this.
+     *  for other implementations changes are ignored.
      */
-    virtual ValueImpl& set(size_t index, const Value& value);
-    virtual ValueImpl& set(size_t index, Value&& value);
+    virtual Value& member(size_t index);
 
     /**
-     *  Retrieve value at the given key
+     *  Look up the value at the given key
      *
-     *  This is only applicable for map values
-     *  so it returns a null value by default.
+     *  This is only applicable for map values,
+     *  so it returns a nullptr by default.
      */
-    virtual Value get(const std::string& key) const;
+    virtual const Value* find(std::string_view key) const;
 
     /**
-     *  Set value at the given key
+     *  Retrieve a modifiable value at the given key,
+     *  the value is created if it does not yet exist
      *
      *  This is only applicable for map values,
-     *  other implementation will ignore this.
+     *  for other implementations changes are ignored.
+     */
+    virtual Value& member(std::string_view key);
+
+    /**
+     *  Look up the element at the given position, to iterate over it
+     *
+     *  For map values the key of the member is stored in the key
+     *  parameter, for array values it is cleared. A nullptr is
+     *  returned after the last element, and for other values.
+     *
+     *  @param  index   position of the element
+     *  @param  key     the key of the element
+     *  @return the value of the element
      */
-    virtual ValueImpl& set(const std::string& key, const Value& value);
-    virtual ValueImpl& set(const std::string& key, Value&& value);
+    virtual const Value* at(size_t index, std::string_view& key) const;
 
     /**
      *  Turn the value into a json compatible type
      */
     virtual struct json_object *toJson() const = 0;
 
+    /**
+     *  Append the value to a json string
+     *
+     *  @param  output
+     */
+    virtual void toJson(std::string& output) const = 0;
+
+    /**
+     *  Append the value to a MessagePack buffer
+     *
+     *  @param  output
+     */
+    virtual void toMsgPack(std::string& output) const = 0;
+
+    /**
+     *  Append the value to a CBOR buffer
+     *
+     *  @param  output
+     */
+    virtual void toCbor(std::string& output) const = 0;
+
+    /**
+     *  Write the value to a snapshot
+     *
+     *  @param  writer
+     *  @return the slot describing the value
+     */
+    virtual SnapshotSlot toSnapshot(SnapshotWriter& writer) const = 0;
+
+    /**
+     *  Calculate the structural hash
+     *
+     *  Values that compare equal have the same hash, for
+     *  every seed. The hash includes the type of the value.
+     *
+     *  @param  seed
+     *  @return uint64_t
+     */
+    virtual uint64_t hash(uint64_t seed) const = 0;
+
     /**
      *  Comparison operator
      */
     virtual bool operator==(const ValueImpl &that) const = 0;
+
+    /**
+     *  Compare with an implementation of the same type
+     *
+     *  This only uses the interface above, so it works for
+     *  every implementation of strings, vectors and maps.
+     *
+     *  @param  that
+     *  @return negative when smaller, zero when equivalent, positive when bigger
+     */
+    int compare(const ValueImpl &that) const;
 };
 
 /**
@@ -0,0 +1,186 @@
+/**
+ *  ValueIterator.h
+ *
+ *  Iterator over the items of a vector, or the members of a map.
+ *  The elements refer to the values in the container, nothing is
+ *  copied. Elements are returned by value, so this is an input
+ *  iterator rather than a forward iterator.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include "ValueImpl.h"
+#include <string_view>
+#include <iterator>
+#include <cstddef>
+
+/**
+ *  Namespace
+ */
+namespace Variant {
+
+/**
+ *  Class definition
+ */
+class ValueIterator
+{
+public:
+    /**
+     *  The element the iterator points to
+     */
+    class Element
+    {
+    private:
+        /**
+         *  The key of a map member, empty for vector items
+         */
+        std::string_view _key;
+
+        /**
+         *  The value of the element
+         */
+        const Value *_value = nullptr;
+
+        /**
+         *  The iterator fills in the element
+         */
+        friend class ValueIterator;
+
+    public:
+        /**
+         *  The key of a map member, or an empty key for vector items
+         *
+         *  @return std::string_view
+         */
+        std::string_view key() const
+        {
+            return _key;
+        }
+
+        /**
+         *  The value of the element
+         *
+         *  @return Value
+         */
+        const Value& value() const
+        {
+            return *_value;
+        }
+
+        /**
+         *  Cast to the value, so items of a vector
+         *  can be iterated over as values directly
+         */
+        operator const Value& () const
+        {
+            return *_value;
+        }
+    };
+
+    /**
+     *  Iterator traits
+     */
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Element;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Element*;
+    using reference = Element;
+
+private:
+    /**
+     *  The container we iterate over
+     */
+    const ValueImpl *_impl = nullptr;
+
+    /**
+     *  The position in the container
+     */
+    size_t _index = 0;
+
+    /**
+     *  The current element
+     */
+    Element _element;
+
+    /**
+     *  Look up the element at the current position
+     */
+    void load()
+    {
+        _element._value = _impl ? _impl->at(_index, _element._key) : nullptr;
+    }
+
+public:
+    /**
+     *  Empty constructor
+     */
+    ValueIterator() {}
+
+    /**
+     *  Constructor
+     *
+     *  @param  impl    the container to iterate over
+     *  @param  index   the position to start at
+     */
+    ValueIterator(const ValueImpl *impl, size_t index) : _impl(impl), _index(index)
+    {
+        load();
+    }
+
+    /**
+     *  Access the current element
+     *
+     *  The element is returned by value, so that it does not
+     *  change when the iterator is moved
+     */
+    reference operator*() const
+    {
+        return _element;
+    }
+
+    /**
+     *  Access the current element
+     *
+     *  The pointer is only valid until the iterator is moved
+     */
+    pointer operator->() const
+    {
+        return &_element;
+    }
+
+    /**
+     *  Move to the next element
+     */
+    ValueIterator& operator++()
+    {
+        ++_index;
+        load();
+        return *this;
+    }
+
+    /**
+     *  Move to the next element
+     */
+    ValueIterator operator++(int)
+    {
+        ValueIterator result = *this;
+        ++*this;
+        return result;
+    }
+
+    /**
+     *  Comparison operators
+     */
+    bool operator==(const ValueIterator &that) const { return _impl == that._impl && _index == that._index; }
+    bool operator!=(const ValueIterator &that) const { return !(*this == that); }
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -13,6 +13,7 @@
 #pragma once
 
 #include "ValueImpl.h"
+#include <type_traits>
 
 /**
  *  Namespace
@@ -30,9 +31,19 @@ class ValueMember : private ValueBase
 {
 private:
     /**
-     *  The base we are working with
+     *  Members of members need access to our slot
      */
-    ValueBase *_base;
+    template <typename> friend class ValueMember;
+
+    /**
+     *  The value we are a member of, if we are a member of a value
+     */
+    Value *_value = nullptr;
+
+    /**
+     *  The member we are a member of, if we are a member of a member
+     */
+    ValueBase *_base = nullptr;
 
     /**
      *  The index we are modifying
@@ -40,99 +51,94 @@ private:
     T _index;
 
     /**
-     *  Retrieve value at the given offset
+     *  Retrieve the value we represent, so that it can be
+     *  modified in place. It is created if it does not exist.
      *
-     *  This is only applicable for array values,
-     *  so it returns a null value by default.
+     *  This must only be called when the value is modified,
+     *  because the value we are part of gets a private copy
+     *  of its implementation at that moment.
      */
-    virtual Value get(size_t index) const
+    Value& slot()
     {
-        return _base->get(_index)[index];
+        // members of members are created by the member they are part of
+        if (_base) return _base->member(_index);
+
+        // the value we are part of must be a container of its own
+        return _value->container(std::is_integral<T>::value ? ValueVectorType : ValueMapType)->member(_index);
     }
 
     /**
-     *  Set value at the given offset
+     *  Look up the value we represent, without modifying anything
      *
-     *  This is only applicable for array value,
-     *  other implementation will ignore this.
+     *  @return the value, or a nullptr if it does not exist
      */
-    virtual ValueBase& set(size_t index, const Value& value)
+    const Value *lookup() const
     {
-        // retrieve current value and set index
-        auto result = _base->get(_index);
-        result[index] = value;
-
-        // store the updated value and allow chaining
-        _base->set(_index, result);
-        return *this;
+        return _base ? _base->find(_index) : _value->find(_index);
     }
 
     /**
-     *  Set value at the given offset
+     *  Look up the value at the given offset
      *
      *  This is only applicable for array values,
-     *  other implementation will ignore this.
+     *  so it returns a nullptr by default.
      */
-    virtual ValueBase& set(size_t index, Value&& value)
+    virtual const Value* find(size_t index) const
     {
-        // retrieve current value and set index
-        auto result = _base->get(_index);
-        result[index] = std::move(value);
-
-        // store the updated value and allow chaining
-        _base->set(_index, result);
-        return *this;
+        // look up the value we represent and the element inside it
+        auto *parent = lookup();
+        return parent ? parent->find(index) : nullptr;
     }
 
     /**
-     *  Retrieve value at the given key
+     *  Retrieve a modifiable value at the given offset,
+     *  the value is created if it does not yet exist
      *
-     *  This is only applicable for mapvalues
-     *  so it returns a null value by default.
+     *  The value we represent is turned into an array
+     *  if it is not one already.
      */
-    virtual Value get(const std::string& key) const
+    virtual Value& member(size_t index)
     {
-        return _base->get(_index)[key];
+        return slot()[index].slot();
     }
 
     /**
-     *  Set value at the given key
+     *  Look up the value at the given key
      *
      *  This is only applicable for map values,
-     *  other implementation will ignore this.
+     *  so it returns a nullptr by default.
      */
-    virtual ValueBase& set(const std::string& key, const Value& value)
+    virtual const Value* find(std::string_view key) const
     {
-        // retrieve current value and set index
-        auto result = _base->get(_index);
-        result[key] = value;
-
-        // store the updated value and allow chaining
-        _base->set(_index, result);
-        return *this;
+        // look up the value we represent and the member inside it
+        auto *parent = lookup();
+        return parent ? parent->find(key) : nullptr;
     }
 
     /**
-     *  Set value at the given key
+     *  Retrieve a modifiable value at the given key,
+     *  the value is created if it does not yet exist
      *
-     *  This is only applicable for map values,
-     *  other implementation will ignore this.
+     *  The value we represent is turned into a map
+     *  if it is not one already.
      */
-    virtual ValueBase& set(const std::string& key, Value&& value)
+    virtual Value& member(std::string_view key)
     {
-        // retrieve current value and set index
-        auto result = _base->get(_index);
-        result[key] = std::move(value);
-
-        // store the updated value and allow chaining
-        _base->set(_index, result);
-        return *this;
+        return slot()[key].slot();
     }
 public:
     /**
-     *  Constructor
+     *  Constructor for a member of a value
+     *
+     *  @param  value   the value we modify
+     *  @param  index   the index we are working at
+     */
+    ValueMember(Value* value, T index) : _value(value), _index(index) {}
+
+    /**
+     *  Constructor for a member of another member
      *
-     *  @param  base    base object we modify
+     *  @param  base    the member we modify
      *  @param  index   the index we are working at
      */
     ValueMember(ValueBase* base, T index) : _base(base), _index(index) {}
@@ -142,7 +148,9 @@ public:
      */
     Value value() const
     {
-        return _base->get(_index);
+        // look up the value, it is null if it does not exist
+        auto *result = lookup();
+        return result ? *result : Value();
     }
 
     /**
@@ -150,7 +158,7 @@ public:
      */
     operator Value () const
     {
-        return _base->get(_index);
+        return value();
     }
 
     /**
@@ -158,7 +166,7 @@ public:
      */
     operator bool () const
     {
-        return _base->get(_index);
+        return value();
     }
 
     /**
@@ -166,7 +174,7 @@ public:
      */
     operator int32_t () const
     {
-        return _base->get(_index);
+        return value();
     }
 
     /**
@@ -174,7 +182,7 @@ public:
      */
     operator int64_t () const
     {
-        return _base->get(_index);
+        return value();
     }
 
     /**
@@ -182,7 +190,7 @@ public:
      */
     operator double () const
     {
-        return _base->get(_index);
+        return value();
     }
 
     /**
@@ -190,17 +198,36 @@ public:
      */
     operator std::string () const
     {
-        return _base->get(_index);
+        // convert the value in place, without copying it first
+        auto *result = lookup();
+        return result ? std::string(*result) : std::string();
+    }
+
+    /**
+     *  The bytes of a string, without copying them
+     *
+     *  The view is valid until the value is modified.
+     */
+    std::string_view view() const
+    {
+        // look up the value, there are no bytes if it does not exist
+        auto *result = lookup();
+        return result ? result->view() : std::string_view();
     }
 
     /**
      *  Assignment operator
      *
+     *  The value is copied before the slot is looked up, because
+     *  it may be part of the same document, and looking up the
+     *  slot can move or copy the members of the document.
+     *
      *  @param  value
      */
     ValueMember& operator=(const Value& value)
     {
-        _base->set(_index, value);
+        Value copy(value);
+        slot() = std::move(copy);
         return *this;
     }
 
@@ -211,7 +238,8 @@ public:
      */
     ValueMember& operator=(Value&& value)
     {
-        _base->set(_index, std::move(value));
+        Value copy(std::move(value));
+        slot() = std::move(copy);
         return *this;
     }
 
@@ -230,8 +258,7 @@ public:
      */
     ValueMember& operator=(const std::vector<Value>& value)
     {
-        _base->set(_index, value);
-        return *this;
+        return *this = Value(value);
     }
 
     /**
@@ -239,8 +266,7 @@ public:
      */
     ValueMember& operator=(std::vector<Value>&& value)
     {
-        _base->set(_index, std::move(value));
-        return *this;
+        return *this = Value(std::move(value));
     }
 
     /**
@@ -258,8 +284,7 @@ public:
      */
     ValueMember& operator=(const std::map<std::string, Value>& value)
     {
-        _base->set(_index, value);
-        return *this;
+        return *this = Value(value);
     }
 
     /**
@@ -269,8 +294,7 @@ public:
      */
     ValueMember& operator=(std::map<std::string, Value>&& value)
     {
-        _base->set(_index, std::move(value));
-        return *this;
+        return *this = Value(std::move(value));
     }
 
     /**
@@ -300,6 +324,15 @@ public:
         return ValueMember<std::string>(this, key);
     }
 
+    /**
+     *  Array access operator
+     *  @param  key
+     */
+    ValueMember<std::string_view> operator [] (std::string_view key)
+    {
+        return ValueMember<std::string_view>(this, key);
+    }
+
     /**
      *  Equals and not equals to operators
      */
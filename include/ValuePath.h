@@ -0,0 +1,211 @@
+/**
+ *  ValuePath.h
+ *
+ *  A path to a value inside a document, that is parsed once and can
+ *  then be looked up in any number of documents, by any number of
+ *  threads at the same time. Looking up a path does not allocate.
+ *
+ *  Paths can be written as a json pointer (RFC 6901), like
+ *  "/order/items/3/sku", or in dotted form, like "order.items[3].sku".
+ *  A number in a json pointer, or between dots, is an index when it
+ *  is applied to a vector, and a key when it is applied to a map. A
+ *  number between brackets is only ever an index. The "-" of a json
+ *  pointer refers to the item after the last one of a vector.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include "JsonError.h"
+#include <string_view>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+// forward declaration
+class Value;
+
+/**
+ *  Class definition
+ */
+class ValuePath
+{
+private:
+    /**
+     *  Index of a step that can not be used as an index
+     */
+    static constexpr size_t none = SIZE_MAX;
+
+    /**
+     *  Index of the item after the last one
+     */
+    static constexpr size_t past = SIZE_MAX - 1;
+
+    /**
+     *  A single step in the path
+     */
+    struct Step
+    {
+        /**
+         *  Position and size of the key
+         *  @var    size_t
+         */
+        size_t offset;
+        size_t size;
+
+        /**
+         *  The index, when the step can be used as one
+         *  @var    size_t
+         */
+        size_t index;
+
+        /**
+         *  Can the step only be used as an index?
+         *  @var    bool
+         */
+        bool element;
+    };
+
+    /**
+     *  The keys of all steps, one after the other
+     *  @var    std::string
+     */
+    std::string _keys;
+
+    /**
+     *  The steps, from the root of the document down
+     *  @var    std::vector<Step>
+     */
+    std::vector<Step> _steps;
+
+    /**
+     *  Could the path be parsed?
+     *  @var    bool
+     */
+    bool _valid = true;
+
+    /**
+     *  The index a token refers to
+     *
+     *  @param  token
+     *  @return the index, or none if the token is not a valid index
+     */
+    static size_t index(std::string_view token);
+
+    /**
+     *  Add a step, its key was already appended to the keys
+     *
+     *  @param  offset      where the key starts
+     *  @param  element     is it only an index?
+     */
+    void add(size_t offset, bool element);
+
+    /**
+     *  Parse a path
+     *
+     *  @param  path        json pointer or dotted path
+     *  @param  error       the reason why the path is invalid
+     */
+    void parse(std::string_view path, JsonError& error);
+
+    /**
+     *  Parse a json pointer
+     *
+     *  @param  path        the pointer, including the leading slash
+     *  @param  error       the error that was found
+     *  @return was the pointer valid?
+     */
+    bool parsePointer(std::string_view path, JsonError& error);
+
+    /**
+     *  Parse a dotted path
+     *
+     *  @param  path        the path
+     *  @param  error       the error that was found
+     *  @return was the path valid?
+     */
+    bool parseDotted(std::string_view path, JsonError& error);
+
+    /**
+     *  The key of a step
+     *
+     *  @param  step
+     *  @return std::string_view
+     */
+    std::string_view key(const Step& step) const
+    {
+        return std::string_view(_keys.data() + step.offset, step.size);
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  An invalid path never finds anything.
+     *
+     *  @param  path        json pointer or dotted path
+     */
+    explicit ValuePath(std::string_view path);
+
+    /**
+     *  Constructor
+     *
+     *  @param  path        json pointer or dotted path
+     *  @param  error       the reason why the path is invalid
+     */
+    ValuePath(std::string_view path, JsonError& error);
+
+    /**
+     *  Could the path be parsed?
+     */
+    explicit operator bool () const { return _valid; }
+
+    /**
+     *  The number of steps in the path
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        return _steps.size();
+    }
+
+    /**
+     *  Look up the value the path points to
+     *
+     *  The pointer is valid until the document is modified.
+     *
+     *  @param  document    the document to look in
+     *  @return the value, or a nullptr if it does not exist
+     */
+    const Value* find(const Value& document) const;
+
+    /**
+     *  Look up the value the path points to, so that it can be modified
+     *
+     *  Members that do not exist are added, and values that are in the
+     *  way are replaced, just like chaining operator[] does. Steps that
+     *  are not an index always add a map. An item can only be added at
+     *  the end of a vector, with its index or with "-". Anything that is
+     *  written through an invalid path, or through an index further
+     *  beyond the end, is lost, but the steps before it may have been
+     *  added already.
+     *
+     *  @param  document    the document to modify
+     *  @return the value
+     */
+    Value& resolveOrCreate(Value& document) const;
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -0,0 +1,459 @@
+/**
+ *  CborParser.h
+ *
+ *  Parser that turns CBOR data straight into Value objects.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include "../include/Value.h"
+#include "ValueVector.h"
+#include "ValueMap.h"
+#include "ValueStringView.h"
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Parser class
+ */
+class CborParser
+{
+private:
+    /**
+     *  Containers can not be nested deeper than this
+     */
+    static const size_t maxDepth = 1024;
+
+    /**
+     *  Argument value that marks an indefinite length
+     */
+    static const uint64_t indefinite = UINT64_MAX;
+
+    /**
+     *  The start of the input, the current position and the end of the input
+     */
+    const unsigned char *_begin;
+    const unsigned char *_current;
+    const unsigned char *_end;
+
+    /**
+     *  Should strings refer to the input instead of being copied?
+     */
+    bool _borrow;
+
+    /**
+     *  Description of the error, if parsing failed
+     */
+    const char *_reason = nullptr;
+
+    /**
+     *  The current nesting depth
+     */
+    size_t _depth = 0;
+
+    /**
+     *  Buffer for strings that are split into chunks, and for map keys
+     */
+    std::string _buffer;
+
+    /**
+     *  Record an error at the current position
+     *
+     *  @param  reason  description of the error
+     *  @return always false
+     */
+    bool fail(const char *reason)
+    {
+        _reason = reason;
+        return false;
+    }
+
+    /**
+     *  Read an initial byte and its argument
+     *
+     *  @param  major       the major type, in the range 0 to 7
+     *  @param  info        the additional information
+     *  @param  argument    the argument, or the indefinite marker
+     *  @return was the header valid?
+     */
+    bool header(uint8_t& major, uint8_t& info, uint64_t& argument)
+    {
+        // the initial byte holds both the major type and the additional information
+        if (_current == _end) return fail("unexpected end of input");
+        major = *_current >> 5;
+        info = *_current++ & 0x1f;
+
+        // small arguments are stored in the initial byte itself
+        if (info < 24) { argument = info; return true; }
+
+        // an indefinite length has no argument, only strings, arrays and maps use it
+        if (info == 31) { argument = indefinite; return (major >= 2 && major <= 5) || fail("unexpected indefinite length"); }
+
+        // the other values are reserved
+        if (info > 27) { --_current; return fail("invalid additional information"); }
+
+        // the argument follows the initial byte
+        size_t bytes = (size_t)1 << (info - 24);
+        if ((size_t)(_end - _current) < bytes) return fail("unexpected end of input");
+
+        // read the argument, most significant byte first
+        argument = 0;
+        for (size_t i = 0; i < bytes; ++i) argument = (argument << 8) | *_current++;
+        return true;
+    }
+
+    /**
+     *  Check whether a length fits in the remaining input
+     *
+     *  Every byte, item and member takes up at least one byte of
+     *  input, which keeps us from reserving memory for data that
+     *  does not exist.
+     *
+     *  @param  length
+     *  @return does it fit?
+     */
+    bool fits(uint64_t length)
+    {
+        return length <= (uint64_t)(_end - _current) || fail("unexpected end of input");
+    }
+
+    /**
+     *  Parse a string, the header has already been read
+     *
+     *  @param  major       the major type of the string
+     *  @param  length      the length, or the indefinite marker
+     *  @param  data        start of the string
+     *  @param  size        size of the string
+     *  @return was the string valid?
+     */
+    bool parseString(uint8_t major, uint64_t length, const char*& data, size_t& size)
+    {
+        // a string with a definite length is found in the input
+        if (length != indefinite)
+        {
+            // the string must fit in the input
+            if (!fits(length)) return false;
+
+            // expose the string
+            data = (const char *)_current;
+            size = length;
+            _current += length;
+            return true;
+        }
+
+        // the chunks of an indefinite string are joined in the buffer
+        _buffer.clear();
+        while (true)
+        {
+            // the string ends with a break
+            if (_current == _end) return fail("unexpected end of input");
+            if (*_current == 0xff) { ++_current; break; }
+
+            // every chunk must be a definite string of the same type
+            uint8_t chunkMajor, info;
+            uint64_t chunkLength;
+            if (!header(chunkMajor, info, chunkLength)) return false;
+            if (chunkMajor != major || chunkLength == indefinite) return fail("invalid string chunk");
+            if (!fits(chunkLength)) return false;
+
+            // add the chunk
+            _buffer.append((const char *)_current, chunkLength);
+            _current += chunkLength;
+        }
+
+        // expose the buffer
+        data = _buffer.data();
+        size = _buffer.size();
+        return true;
+    }
+
+    /**
+     *  Check whether we reached the end of a container
+     *
+     *  @param  length      the length of the container, or the indefinite marker
+     *  @param  count       the number of elements seen so far
+     *  @return did we reach the end?
+     */
+    bool complete(uint64_t length, uint64_t count)
+    {
+        // containers with a definite length end after the given number of elements
+        if (length != indefinite) return count == length;
+
+        // other containers end with a break
+        if (_current == _end || *_current != 0xff) return false;
+        ++_current;
+        return true;
+    }
+
+    /**
+     *  Parse the items of an array
+     *
+     *  @param  length  number of items, or the indefinite marker
+     *  @param  result
+     *  @return was this a valid array?
+     */
+    bool parseArray(uint64_t length, Value& result)
+    {
+        // items are added straight into the vector
+        auto *vector = ValueImpl::create<ValueVector>();
+        result = Value(vector);
+
+        // allocate the storage once, if we know the size
+        if (length != indefinite) vector->reserve(length);
+
+        // parse all the items
+        for (uint64_t count = 0; !complete(length, count); ++count)
+        {
+            if (!parseValue(vector->append())) return false;
+        }
+
+        // the array is complete
+        return true;
+    }
+
+    /**
+     *  Parse the members of a map
+     *
+     *  @param  length  number of members, or the indefinite marker
+     *  @param  result
+     *  @return was this a valid map?
+     */
+    bool parseMap(uint64_t length, Value& result)
+    {
+        // members are added straight into the map
+        auto *map = ValueImpl::create<ValueMap>();
+        result = Value(map);
+
+        // parse all the members
+        for (uint64_t count = 0; !complete(length, count); ++count)
+        {
+            // the key must be a text string
+            const char *data;
+            size_t size;
+            uint8_t major, info;
+            uint64_t argument;
+            if (!header(major, info, argument)) return false;
+            if (major != 3) { --_current; return fail("map key is not a string"); }
+            if (!parseString(major, argument, data, size)) return false;
+
+            // parse the value straight into the map
+            if (!parseValue(map->member(std::string_view(data, size)))) return false;
+        }
+
+        // the map is complete
+        return true;
+    }
+
+    /**
+     *  Parse an array or map, while keeping track of the nesting depth
+     *
+     *  @param  major   the major type
+     *  @param  length  number of elements, or the indefinite marker
+     *  @param  result
+     *  @return was this a valid container?
+     */
+    bool parseContainer(uint8_t major, uint64_t length, Value& result)
+    {
+        // prevent unbounded recursion
+        if (_depth == maxDepth) return fail("nesting too deep");
+
+        // the elements must fit in the input
+        if (length != indefinite && !fits(length)) return false;
+
+        // parse the container
+        ++_depth;
+        bool success = major == 5 ? parseMap(length, result) : parseArray(length, result);
+        --_depth;
+        return success;
+    }
+
+    /**
+     *  Convert a half precision float to a double
+     *
+     *  @param  bits
+     *  @return double
+     */
+    static double half(uint16_t bits)
+    {
+        // split the number in its parts
+        int exponent = (bits >> 10) & 0x1f;
+        double mantissa = bits & 0x3ff;
+
+        // calculate the value
+        double value;
+        if (exponent == 0) value = std::ldexp(mantissa, -24);
+        else if (exponent != 31) value = std::ldexp(mantissa + 1024, exponent - 25);
+        else value = mantissa == 0 ? INFINITY : NAN;
+
+        // apply the sign
+        return bits & 0x8000 ? -value : value;
+    }
+
+    /**
+     *  Parse a simple value or a floating point number
+     *
+     *  @param  info        the additional information
+     *  @param  argument    the argument
+     *  @param  result
+     *  @return was this a valid value?
+     */
+    bool parseSimple(uint8_t info, uint64_t argument, Value& result)
+    {
+        switch (info)
+        {
+            case 20:    result = false; return true;
+            case 21:    result = true; return true;
+            case 22:    // null
+            case 23:    result = Value(); return true;
+            case 25:    result = half(argument); return true;
+            case 26:
+            {
+                // copy the bits into a float
+                uint32_t bits = argument;
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+                result = (double)value;
+                return true;
+            }
+            case 27:
+            {
+                // copy the bits into a double
+                double value;
+                std::memcpy(&value, &argument, sizeof(value));
+                result = value;
+                return true;
+            }
+            default:    return fail("unsupported simple value");
+        }
+    }
+
+    /**
+     *  Parse an integer
+     *
+     *  Integers with an argument of up to four bytes that fit become
+     *  32 bit integers, the others become 64 bit integers, or doubles
+     *  when they do not fit in a 64 bit integer either.
+     *
+     *  @param  negative    is this a negative integer?
+     *  @param  info        the additional information
+     *  @param  argument    the argument
+     *  @param  result
+     */
+    static void parseInteger(bool negative, uint8_t info, uint64_t argument, Value& result)
+    {
+        // small numbers become 32 bit integers
+        if (info < 27 && argument <= (uint64_t)INT32_MAX) result = negative ? (int32_t)(-1 - (int64_t)argument) : (int32_t)argument;
+
+        // other numbers that fit become 64 bit integers
+        else if (argument <= (uint64_t)INT64_MAX) result = negative ? -1 - (int64_t)argument : (int64_t)argument;
+
+        // and the rest becomes a double
+        else result = negative ? -1.0 - (double)argument : (double)argument;
+    }
+
+    /**
+     *  Parse a value
+     *
+     *  @param  result
+     *  @return was this a valid value?
+     */
+    bool parseValue(Value& result)
+    {
+        // tags are skipped, we only care about the value they apply to
+        uint8_t major, info;
+        uint64_t argument;
+        do
+        {
+            if (!header(major, info, argument)) return false;
+        }
+        while (major == 6);
+
+        // check the major type
+        switch (major)
+        {
+            case 0:
+            case 1:     parseInteger(major == 1, info, argument, result); return true;
+            case 2:
+            case 3:
+            {
+                // parse the string
+                const char *data;
+                size_t size;
+                if (!parseString(major, argument, data, size)) return false;
+
+                // refer to the input if we may, strings in the buffer must always be copied
+                if (_borrow && data != _buffer.data()) result = Value(ValueImpl::create<ValueStringView>(std::string_view(data, size)));
+                else result = Value(data, size);
+                return true;
+            }
+            case 4:
+            case 5:     return parseContainer(major, argument, result);
+            default:    return parseSimple(info, argument, result);
+        }
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  @param  data    the CBOR data to parse
+     *  @param  borrow  should strings refer to the data, instead of being copied?
+     */
+    CborParser(std::string_view data, bool borrow) :
+        _begin((const unsigned char *)data.data()),
+        _current((const unsigned char *)data.data()),
+        _end((const unsigned char *)data.data() + data.size()),
+        _borrow(borrow) {}
+
+    /**
+     *  Parse the data
+     *
+     *  @param  result  the parsed value
+     *  @return was the data valid CBOR?
+     */
+    bool parse(Value& result)
+    {
+        // parse the value, nothing may follow it
+        if (!parseValue(result)) return false;
+        return _current == _end || fail("unexpected data after value");
+    }
+
+    /**
+     *  The offset in the input where parsing failed
+     *
+     *  @return size_t
+     */
+    size_t offset() const
+    {
+        return _current - _begin;
+    }
+
+    /**
+     *  Description of the reason why parsing failed
+     *
+     *  @return the reason, or a nullptr if parsing succeeded
+     */
+    const char *reason() const
+    {
+        return _reason;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -0,0 +1,168 @@
+/**
+ *  CborWriter.h
+ *
+ *  Helper functions to append CBOR encoded
+ *  values and headers to an output buffer.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Writer class
+ */
+class CborWriter
+{
+private:
+    /**
+     *  Append the initial byte and its argument, using the given number of bytes
+     *
+     *  @param  output
+     *  @param  major   the major type, already shifted into the upper three bits
+     *  @param  value   the argument
+     *  @param  bytes   size of the argument: 1, 2, 4 or 8
+     */
+    static void append(std::string& output, uint8_t major, uint64_t value, size_t bytes)
+    {
+        // the additional information tells the size of the argument
+        char buffer[9] = { (char)(major | (bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27)) };
+
+        // followed by the argument, most significant byte first
+        for (size_t i = 0; i < bytes; ++i) buffer[bytes - i] = (char)(value >> (8 * i));
+        output.append(buffer, bytes + 1);
+    }
+
+    /**
+     *  Append the initial byte and its argument, in the most compact format
+     *
+     *  @param  output
+     *  @param  major   the major type, already shifted into the upper three bits
+     *  @param  value   the argument
+     */
+    static void header(std::string& output, uint8_t major, uint64_t value)
+    {
+        if (value < 24) output.push_back((char)(major | value));
+        else if (value <= UINT8_MAX) append(output, major, value, 1);
+        else if (value <= UINT16_MAX) append(output, major, value, 2);
+        else if (value <= UINT32_MAX) append(output, major, value, 4);
+        else append(output, major, value, 8);
+    }
+
+public:
+    /**
+     *  Append null
+     *
+     *  @param  output
+     */
+    static void null(std::string& output)
+    {
+        output.push_back((char)0xf6);
+    }
+
+    /**
+     *  Append a boolean
+     *
+     *  @param  output
+     *  @param  value
+     */
+    static void boolean(std::string& output, bool value)
+    {
+        output.push_back((char)(value ? 0xf5 : 0xf4));
+    }
+
+    /**
+     *  Append a 32 bit integer, in the most compact format
+     *
+     *  @param  output
+     *  @param  value
+     */
+    static void number(std::string& output, int32_t value)
+    {
+        // negative numbers are stored as minus one minus the argument
+        if (value >= 0) header(output, 0x00, value);
+        else header(output, 0x20, (uint32_t)(-1 - value));
+    }
+
+    /**
+     *  Append a 64 bit integer
+     *
+     *  This always uses an eight byte argument, so that the
+     *  value is decoded as a 64 bit integer again.
+     *
+     *  @param  output
+     *  @param  value
+     */
+    static void number(std::string& output, int64_t value)
+    {
+        // negative numbers are stored as minus one minus the argument
+        if (value >= 0) append(output, 0x00, value, 8);
+        else append(output, 0x20, (uint64_t)(-1 - value), 8);
+    }
+
+    /**
+     *  Append a floating point number
+     *
+     *  @param  output
+     *  @param  value
+     */
+    static void number(std::string& output, double value)
+    {
+        // copy the bits of the number, and store them as a simple value
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        append(output, 0xe0, bits, 8);
+    }
+
+    /**
+     *  Append a text string
+     *
+     *  @param  output
+     *  @param  data
+     *  @param  size
+     */
+    static void string(std::string& output, const char *data, size_t size)
+    {
+        header(output, 0x60, size);
+        output.append(data, size);
+    }
+
+    /**
+     *  Append the header of an array, the items must follow it
+     *
+     *  @param  output
+     *  @param  size    number of items
+     */
+    static void array(std::string& output, size_t size)
+    {
+        header(output, 0x80, size);
+    }
+
+    /**
+     *  Append the header of a map, the keys and values must follow it
+     *
+     *  @param  output
+     *  @param  size    number of members
+     */
+    static void map(std::string& output, size_t size)
+    {
+        header(output, 0xa0, size);
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -0,0 +1,89 @@
+/**
+ *  Hash.h
+ *
+ *  Helper functions to calculate the structural hash of a value.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Hash class
+ */
+class Hash
+{
+public:
+    /**
+     *  Scramble the bits of a number, so that every input bit
+     *  affects every output bit
+     *
+     *  @param  value
+     *  @return uint64_t
+     */
+    static uint64_t finalize(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccd;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53;
+        value ^= value >> 33;
+        return value;
+    }
+
+    /**
+     *  Combine a hash with a number, the order matters
+     *
+     *  @param  hash    the hash so far
+     *  @param  value   the number to add
+     *  @return uint64_t
+     */
+    static uint64_t mix(uint64_t hash, uint64_t value)
+    {
+        return finalize(hash * 0x9e3779b97f4a7c15 ^ value);
+    }
+
+    /**
+     *  Hash a series of bytes
+     *
+     *  @param  hash    the hash so far
+     *  @param  data    the bytes
+     *  @param  size    number of bytes
+     *  @return uint64_t
+     */
+    static uint64_t bytes(uint64_t hash, const char *data, size_t size)
+    {
+        // add the bytes eight at a time
+        const char *end = data + size;
+        for (; end - data >= 8; data += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            hash = mix(hash, word);
+        }
+
+        // the remaining bytes are added together with the size,
+        // so strings that only differ in trailing zeroes differ, an
+        // empty string may not have any data to copy from at all
+        uint64_t word = 0;
+        if (end > data) std::memcpy(&word, data, end - data);
+        return mix(hash, word ^ ((uint64_t)size << 56));
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
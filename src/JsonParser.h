@@ -0,0 +1,864 @@
+/**
+ *  JsonParser.h
+ *
+ *  Parser that turns json text straight into Value
+ *  objects, without building an intermediate tree.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include "../include/Value.h"
+#include "../include/JsonHandler.h"
+#include "ValueVector.h"
+#include "ValueMap.h"
+#include "ValueLazy.h"
+#include "JsonSource.h"
+#include <string_view>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Parser class
+ */
+class JsonParser
+{
+private:
+    /**
+     *  Containers can not be nested deeper than this
+     */
+    static const size_t maxDepth = 1024;
+
+    /**
+     *  The start of the input, the current position and the end of the input
+     */
+    const char *_begin;
+    const char *_current;
+    const char *_end;
+
+    /**
+     *  Description of the error, if parsing failed
+     */
+    const char *_reason = nullptr;
+
+    /**
+     *  Did the event handler stop the parser?
+     */
+    bool _stopped = false;
+
+    /**
+     *  The current nesting depth
+     */
+    size_t _depth = 0;
+
+    /**
+     *  Buffer for strings that contain escape sequences
+     */
+    std::string _buffer;
+
+    /**
+     *  Buffer for the key of an object member
+     */
+    std::string _key;
+
+    /**
+     *  Where to record the containers while indexing a document
+     */
+    std::vector<JsonSource::Container> *_containers = nullptr;
+
+    /**
+     *  The indexed document, when nested containers should become
+     *  lazy values, and the index of the next container we meet
+     */
+    std::shared_ptr<const JsonSource> _source;
+    size_t _node = 0;
+
+    /**
+     *  Record an error at the current position
+     *
+     *  @param  reason  description of the error
+     *  @return always false
+     */
+    bool fail(const char *reason)
+    {
+        _reason = reason;
+        return false;
+    }
+
+    /**
+     *  Skip over whitespace
+     */
+    void skipWhitespace()
+    {
+        while (_current < _end && (*_current == ' ' || *_current == '\n' || *_current == '\r' || *_current == '\t')) ++_current;
+    }
+
+    /**
+     *  Find the first quote, backslash or control character, starting at the given position
+     *
+     *  @param  current
+     *  @return position of the character, or the end of the input
+     */
+    const char *scan(const char *current) const
+    {
+#ifdef __SSE2__
+        // check sixteen bytes at a time
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x1F);
+        while (_end - current >= 16)
+        {
+            // compare the block with both characters, and find the bytes that an unsigned maximum with 0x1F leaves alone
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(current));
+            __m128i special = _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash));
+            int mask = _mm_movemask_epi8(_mm_or_si128(special, _mm_cmpeq_epi8(_mm_max_epu8(block, control), control)));
+
+            // the lowest set bit tells us where the first match is
+            if (mask) return current + __builtin_ctz(mask);
+
+            // move on to the next block
+            current += 16;
+        }
+#endif
+        // check the remaining bytes one by one
+        while (current < _end && *current != '"' && *current != '\\' && (unsigned char)*current >= 0x20) ++current;
+        return current;
+    }
+
+    /**
+     *  Append a unicode code point to a buffer, encoded as utf-8
+     *
+     *  @param  buffer
+     *  @param  codepoint
+     */
+    static void append(std::string& buffer, uint32_t codepoint)
+    {
+        if (codepoint < 0x80) buffer.push_back(codepoint);
+        else if (codepoint < 0x800)
+        {
+            buffer.push_back(0xC0 | (codepoint >> 6));
+            buffer.push_back(0x80 | (codepoint & 0x3F));
+        }
+        else if (codepoint < 0x10000)
+        {
+            buffer.push_back(0xE0 | (codepoint >> 12));
+            buffer.push_back(0x80 | ((codepoint >> 6) & 0x3F));
+            buffer.push_back(0x80 | (codepoint & 0x3F));
+        }
+        else
+        {
+            buffer.push_back(0xF0 | (codepoint >> 18));
+            buffer.push_back(0x80 | ((codepoint >> 12) & 0x3F));
+            buffer.push_back(0x80 | ((codepoint >> 6) & 0x3F));
+            buffer.push_back(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    /**
+     *  Parse the four hexadecimal digits of a \u escape sequence
+     *
+     *  @param  codepoint   the parsed value
+     *  @return did we find four valid digits?
+     */
+    bool parseHex(uint32_t& codepoint)
+    {
+        // we need four digits
+        if (_end - _current < 4 || std::from_chars(_current, _current + 4, codepoint, 16).ptr != _current + 4) return fail("invalid unicode escape");
+
+        // skip the digits
+        _current += 4;
+        return true;
+    }
+
+    /**
+     *  Parse a string, the opening quote has already been consumed
+     *
+     *  The resulting string is exposed through the data and size
+     *  parameters, which either point into the input (when the string
+     *  contains no escape sequences) or into the given buffer.
+     *
+     *  @param  buffer      buffer to unescape the string into
+     *  @param  data        start of the string
+     *  @param  size        size of the string
+     *  @return did the string end properly?
+     */
+    bool parseString(std::string& buffer, const char*& data, size_t& size)
+    {
+        // find the first quote or backslash
+        const char *start = _current;
+        _current = scan(_current);
+        if (_current == _end) return fail("unterminated string");
+        if ((unsigned char)*_current < 0x20) return fail("control character in string");
+
+        // without escape sequences we can use the input directly
+        if (*_current == '"')
+        {
+            data = start;
+            size = _current++ - start;
+            return true;
+        }
+
+        // copy the string into the buffer while unescaping it
+        buffer.assign(start, _current);
+        while (true)
+        {
+            // end of the string?
+            if (*_current++ == '"') break;
+
+            // the escape sequence needs at least one more byte
+            if (_current == _end) return fail("unterminated string");
+
+            // check which character was escaped
+            switch (*_current++)
+            {
+                case '"':   buffer.push_back('"'); break;
+                case '\\':  buffer.push_back('\\'); break;
+                case '/':   buffer.push_back('/'); break;
+                case 'b':   buffer.push_back('\b'); break;
+                case 'f':   buffer.push_back('\f'); break;
+                case 'n':   buffer.push_back('\n'); break;
+                case 'r':   buffer.push_back('\r'); break;
+                case 't':   buffer.push_back('\t'); break;
+                case 'u':
+                {
+                    // parse the code point
+                    uint32_t codepoint = 0;
+                    if (!parseHex(codepoint)) return false;
+
+                    // a high surrogate should be followed by a low surrogate
+                    if (codepoint >= 0xD800 && codepoint < 0xDC00 && _end - _current >= 6 && _current[0] == '\\' && _current[1] == 'u')
+                    {
+                        // look at the next escape, without consuming it yet
+                        uint32_t low = 0;
+                        bool valid = std::from_chars(_current + 2, _current + 6, low, 16).ptr == _current + 6;
+
+                        // only a low surrogate completes the pair, anything else is a character of its own
+                        if (valid && low >= 0xDC00 && low < 0xE000)
+                        {
+                            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                            _current += 6;
+                        }
+                    }
+
+                    // lone surrogates can not be encoded
+                    if (codepoint >= 0xD800 && codepoint < 0xE000) codepoint = 0xFFFD;
+
+                    // add the character
+                    append(buffer, codepoint);
+                    break;
+                }
+                default:    --_current; return fail("invalid escape sequence");
+            }
+
+            // copy everything up to the next quote or backslash
+            const char *next = scan(_current);
+            if (next == _end) return fail("unterminated string");
+            buffer.append(_current, next);
+            _current = next;
+
+            // control characters must be escaped
+            if ((unsigned char)*_current < 0x20) return fail("control character in string");
+        }
+
+        // expose the buffer
+        data = buffer.data();
+        size = buffer.size();
+        return true;
+    }
+
+    /**
+     *  Parse a number
+     *
+     *  Numbers without a fraction or exponent that fit in a
+     *  64 bit integer become integers, all others become doubles.
+     *
+     *  @param  result
+     *  @return was this a valid number?
+     */
+    bool parseNumber(Value& result)
+    {
+        // remember where the number started
+        const char *start = _current;
+
+        // check for a sign
+        bool negative = *_current == '-';
+        if (negative) ++_current;
+
+        // there must be at least one digit
+        if (_current == _end || *_current < '0' || *_current > '9') return fail(negative ? "invalid number" : "unexpected character");
+
+        // parse the integer part, while we can still be sure it fits
+        uint64_t integer = 0;
+        const char *digits = _current;
+        while (_current < _end && *_current >= '0' && *_current <= '9')
+        {
+            if (_current - digits < 19) integer = integer * 10 + (*_current - '0');
+            ++_current;
+        }
+
+        // only zero itself may start with a zero
+        if (*digits == '0' && _current - digits > 1) return fail("leading zero in number");
+
+        // check for a fraction or exponent
+        bool real = _current < _end && (*_current == '.' || *_current == 'e' || *_current == 'E');
+
+        // integers with up to 18 digits always fit, longer ones must be checked
+        if (!real && _current - digits <= 18)
+        {
+            result = negative ? -(int64_t)integer : (int64_t)integer;
+            return true;
+        }
+        if (!real && _current - digits == 19 && integer <= (uint64_t)INT64_MAX + negative)
+        {
+            result = negative ? (int64_t)(0 - integer) : (int64_t)integer;
+            return true;
+        }
+
+        // skip over the fraction
+        if (_current < _end && *_current == '.')
+        {
+            // there must be at least one digit
+            if (++_current == _end || *_current < '0' || *_current > '9') return fail("invalid number");
+            while (_current < _end && *_current >= '0' && *_current <= '9') ++_current;
+        }
+
+        // skip over the exponent
+        if (_current < _end && (*_current == 'e' || *_current == 'E'))
+        {
+            // the sign is optional, but there must be at least one digit
+            if (++_current < _end && (*_current == '+' || *_current == '-')) ++_current;
+            if (_current == _end || *_current < '0' || *_current > '9') return fail("invalid number");
+            while (_current < _end && *_current >= '0' && *_current <= '9') ++_current;
+        }
+
+        // let the standard library do the hard work
+        double number = 0.0;
+        auto converted = std::from_chars(start, _current, number);
+
+        // numbers that are too large are stored as infinity
+        if (converted.ec == std::errc::result_out_of_range) number = negative ? -HUGE_VAL : HUGE_VAL;
+
+        // store the number
+        result = number;
+        return true;
+    }
+
+    /**
+     *  Parse a literal like true, false or null
+     *
+     *  @param  word    the expected literal
+     *  @param  size    size of the literal
+     *  @return did the input hold the literal?
+     */
+    bool parseLiteral(const char *word, size_t size)
+    {
+        // the input must be large enough and match
+        if ((size_t)(_end - _current) < size || std::char_traits<char>::compare(_current, word, size) != 0) return fail("invalid literal");
+
+        // skip the literal
+        _current += size;
+        return true;
+    }
+
+    /**
+     *  Parse the items of an array, the opening bracket has already been consumed
+     *
+     *  @param  vector  the vector to add the items to
+     *  @return was this a valid array?
+     */
+    bool parseItems(ValueVector *vector)
+    {
+        // check for an empty array
+        skipWhitespace();
+        if (_current < _end && *_current == ']')
+        {
+            ++_current;
+            return true;
+        }
+
+        // parse all the items
+        while (true)
+        {
+            // parse the next item straight into the vector
+            if (!parseValue(vector->append())) return false;
+
+            // the item is followed by either a comma or the closing bracket
+            skipWhitespace();
+            if (_current == _end) return fail("unexpected end of input");
+            if (*_current == ',') { ++_current; continue; }
+            if (*_current != ']') return fail("expected ',' or ']'");
+            ++_current;
+
+            // the array is complete
+            return true;
+        }
+    }
+
+    /**
+     *  Parse an array, the opening bracket has already been consumed
+     *
+     *  @param  result
+     *  @return was this a valid array?
+     */
+    bool parseArray(Value& result)
+    {
+        // items are added straight into the vector
+        auto *vector = ValueImpl::create<ValueVector>();
+        result = Value(vector);
+
+        // parse the items
+        return parseItems(vector);
+    }
+
+    /**
+     *  Parse an object, the opening brace has already been consumed
+     *
+     *  @param  result
+     *  @return was this a valid object?
+     */
+    bool parseObject(Value& result)
+    {
+        // members are added straight into the map
+        auto *map = ValueImpl::create<ValueMap>();
+        result = Value(map);
+
+        // parse the members
+        return parseMembers(map);
+    }
+
+    /**
+     *  Parse the members of an object, the opening brace has already been consumed
+     *
+     *  @param  map     the map to add the members to
+     *  @return was this a valid object?
+     */
+    bool parseMembers(ValueMap *map)
+    {
+        // check for an empty object
+        skipWhitespace();
+        if (_current < _end && *_current == '}')
+        {
+            ++_current;
+            return true;
+        }
+
+        // parse all the members
+        while (true)
+        {
+            // every member starts with a key
+            skipWhitespace();
+            if (_current == _end) return fail("unexpected end of input");
+            if (*_current++ != '"') { --_current; return fail("expected string as object key"); }
+
+            // parse the key
+            const char *data;
+            size_t size;
+            if (!parseString(_key, data, size)) return false;
+            if (data != _key.data()) _key.assign(data, size);
+
+            // the key is followed by a colon
+            skipWhitespace();
+            if (_current == _end) return fail("unexpected end of input");
+            if (*_current++ != ':') { --_current; return fail("expected ':'"); }
+
+            // parse the value straight into the map
+            if (!parseValue(map->member(_key))) return false;
+
+            // the member is followed by either a comma or the closing brace
+            skipWhitespace();
+            if (_current == _end) return fail("unexpected end of input");
+            if (*_current == ',') { ++_current; continue; }
+            if (*_current != '}') return fail("expected ',' or '}'");
+            ++_current;
+
+            // the object is complete
+            return true;
+        }
+    }
+
+    /**
+     *  Parse a value
+     *
+     *  @param  result
+     *  @return was this a valid value?
+     */
+    bool parseValue(Value& result)
+    {
+        // skip leading whitespace
+        skipWhitespace();
+        if (_current == _end) return fail("unexpected end of input");
+
+        // check what type of value this is
+        switch (*_current)
+        {
+            case '"':
+            {
+                // skip the quote and parse the string
+                const char *data;
+                size_t size;
+                ++_current;
+                if (!parseString(_buffer, data, size)) return false;
+
+                // store the string
+                result = Value(data, size);
+                return true;
+            }
+            case '{':
+            case '[':
+            {
+                // nested containers of an indexed document are decoded later
+                if (_source) return parseLazy(result);
+
+                // prevent unbounded recursion
+                if (_depth == maxDepth) return fail("nesting too deep");
+
+                // parse the container
+                ++_depth;
+                bool success = *_current++ == '{' ? parseObject(result) : parseArray(result);
+                --_depth;
+                return success;
+            }
+            case 't':   result = true; return parseLiteral("true", 4);
+            case 'f':   result = false; return parseLiteral("false", 5);
+            case 'n':   result = Value(); return parseLiteral("null", 4);
+            default:    return parseNumber(result);
+        }
+    }
+
+    /**
+     *  Turn the container at the current position into a lazy value
+     *
+     *  @param  result
+     *  @return always true, the document was checked while indexing
+     */
+    bool parseLazy(Value& result)
+    {
+        // look up the container in the index
+        const auto &container = _source->containers[_node];
+
+        // create the value, and skip over the container and everything in it
+        result = Value(ValueImpl::create<ValueLazy>(_source, _node));
+        _current = _begin + container.end;
+        _node += 1 + container.descendants;
+        return true;
+    }
+
+    /**
+     *  Stop the parser at the request of the handler
+     *
+     *  @return always false
+     */
+    bool stop()
+    {
+        _stopped = true;
+        return false;
+    }
+
+    /**
+     *  Report the value of an object member or array item to a handler
+     *
+     *  @param  handler     the handler
+     *  @param  action      what the handler wants to do with the value
+     *  @return was this a valid value?
+     */
+    bool visitElement(JsonHandler *handler, JsonAction action)
+    {
+        switch (action)
+        {
+        case JsonVisit:
+            return visitValue(handler);
+
+        case JsonSkip:
+            return visitValue(nullptr);
+
+        case JsonCapture:
+        {
+            // build the value and pass it on
+            Value value;
+            if (!parseValue(value)) return false;
+            return handler->onValue(std::move(value)) || stop();
+        }
+
+        default:
+            return stop();
+        }
+    }
+
+    /**
+     *  Report an array to a handler, the opening bracket has already been consumed
+     *
+     *  @param  handler     the handler, or a nullptr to skip the array
+     *  @return was this a valid array?
+     */
+    bool visitArray(JsonHandler *handler)
+    {
+        // report the start of the array
+        if (handler && !handler->onStartArray()) return stop();
+
+        // check for an empty array
+        skipWhitespace();
+        if (_current < _end && *_current == ']') ++_current;
+
+        // otherwise, visit all items
+        else for (size_t index = 0; true; ++index)
+        {
+            // ask the handler what to do with the next item
+            if (!visitElement(handler, handler ? handler->onItem(index) : JsonSkip)) return false;
+
+            // the item is followed by either a comma or the closing bracket
+            skipWhitespace();
+            if (_current == _end) return fail("unexpected end of input");
+            if (*_current == ',') { ++_current; continue; }
+            if (*_current != ']') return fail("expected ',' or ']'");
+            ++_current;
+            break;
+        }
+
+        // report the end of the array
+        return !handler || handler->onEndArray() || stop();
+    }
+
+    /**
+     *  Report an object to a handler, the opening brace has already been consumed
+     *
+     *  @param  handler     the handler, or a nullptr to skip the object
+     *  @return was this a valid object?
+     */
+    bool visitObject(JsonHandler *handler)
+    {
+        // report the start of the object
+        if (handler && !handler->onStartObject()) return stop();
+
+        // check for an empty object
+        skipWhitespace();
+        if (_current < _end && *_current == '}') ++_current;
+
+        // otherwise, visit all members
+        else while (true)
+        {
+            // every member starts with a key
+            skipWhitespace();
+            if (_current == _end) return fail("unexpected end of input");
+            if (*_current++ != '"') { --_current; return fail("expected string as object key"); }
+
+            // parse the key
+            const char *data;
+            size_t size;
+            if (!parseString(_key, data, size)) return false;
+
+            // the key is followed by a colon
+            skipWhitespace();
+            if (_current == _end) return fail("unexpected end of input");
+            if (*_current++ != ':') { --_current; return fail("expected ':'"); }
+
+            // ask the handler what to do with the value
+            if (!visitElement(handler, handler ? handler->onKey(std::string_view(data, size)) : JsonSkip)) return false;
+
+            // the member is followed by either a comma or the closing brace
+            skipWhitespace();
+            if (_current == _end) return fail("unexpected end of input");
+            if (*_current == ',') { ++_current; continue; }
+            if (*_current != '}') return fail("expected ',' or '}'");
+            ++_current;
+            break;
+        }
+
+        // report the end of the object
+        return !handler || handler->onEndObject() || stop();
+    }
+
+    /**
+     *  Report a value to a handler
+     *
+     *  Without a handler the value is only checked and skipped,
+     *  which does not allocate any memory.
+     *
+     *  @param  handler     the handler, or a nullptr to skip the value
+     *  @return was this a valid value?
+     */
+    bool visitValue(JsonHandler *handler)
+    {
+        // skip leading whitespace
+        skipWhitespace();
+        if (_current == _end) return fail("unexpected end of input");
+
+        // check what type of value this is
+        switch (*_current)
+        {
+            case '"':
+            {
+                // skip the quote and parse the string
+                const char *data;
+                size_t size;
+                ++_current;
+                if (!parseString(_buffer, data, size)) return false;
+
+                // report the string
+                return !handler || handler->onString(std::string_view(data, size)) || stop();
+            }
+            case '{':
+            case '[':
+            {
+                // prevent unbounded recursion
+                if (_depth == maxDepth) return fail("nesting too deep");
+
+                // record where the container starts, when indexing
+                size_t node = _containers ? _containers->size() : 0;
+                if (_containers) _containers->push_back(JsonSource::Container{ (size_t)(_current - _begin), 0, 0 });
+
+                // visit the container
+                ++_depth;
+                bool success = *_current++ == '{' ? visitObject(handler) : visitArray(handler);
+                --_depth;
+
+                // record where it ends, and what is nested inside it
+                if (_containers && success)
+                {
+                    (*_containers)[node].end = _current - _begin;
+                    (*_containers)[node].descendants = _containers->size() - node - 1;
+                }
+                return success;
+            }
+            case 't':   return parseLiteral("true", 4) && (!handler || handler->onBool(true) || stop());
+            case 'f':   return parseLiteral("false", 5) && (!handler || handler->onBool(false) || stop());
+            case 'n':   return parseLiteral("null", 4) && (!handler || handler->onNull() || stop());
+            default:
+            {
+                // numbers are parsed into a scalar value, which does not allocate
+                Value number;
+                if (!parseNumber(number)) return false;
+
+                // report the number
+                if (!handler) return true;
+                if (number.type() == ValueInt64Type) return handler->onInteger(number) || stop();
+                return handler->onDouble(number) || stop();
+            }
+        }
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  @param  json    the json text to parse
+     */
+    JsonParser(std::string_view json) : _begin(json.data()), _current(json.data()), _end(json.data() + json.size()) {}
+
+    /**
+     *  Parse the json text
+     *
+     *  @param  result  the parsed value
+     *  @return was the text valid json?
+     */
+    bool parse(Value& result)
+    {
+        // parse the value, nothing but whitespace may follow it
+        if (!parseValue(result)) return false;
+        skipWhitespace();
+        return _current == _end || fail("unexpected data after value");
+    }
+
+    /**
+     *  Parse the json text and report it to a handler
+     *
+     *  @param  handler the handler to report to
+     *  @return was the text valid json, or did the handler stop the parser?
+     */
+    bool parse(JsonHandler& handler)
+    {
+        // visit the value, nothing but whitespace may follow it
+        if (!visitValue(&handler)) return _stopped;
+        skipWhitespace();
+        return _current == _end || fail("unexpected data after value");
+    }
+
+    /**
+     *  Check the json text, and record the containers in it
+     *
+     *  @param  source  the document that holds the json text
+     *  @return was the text valid json?
+     */
+    bool index(JsonSource& source)
+    {
+        // skip the value while recording its containers
+        _containers = &source.containers;
+        if (!visitValue(nullptr)) return false;
+
+        // nothing but whitespace may follow it
+        skipWhitespace();
+        return _current == _end || fail("unexpected data after value");
+    }
+
+    /**
+     *  Decode a single level of a container in an indexed document
+     *
+     *  The parser must have been constructed with the text of the
+     *  document. Containers nested in it become lazy values.
+     *
+     *  @param  source  the indexed document
+     *  @param  node    index of the container to decode
+     *  @return the decoded map or vector
+     */
+    ValueImpl *parseLevel(const std::shared_ptr<const JsonSource>& source, size_t node)
+    {
+        // move to the start of the container, its first child is the next container
+        _source = source;
+        _current = _begin + source->containers[node].begin + 1;
+        _node = node + 1;
+
+        // decode an object
+        if (_current[-1] == '{')
+        {
+            auto *map = ValueImpl::create<ValueMap>();
+            parseMembers(map);
+            return map;
+        }
+
+        // decode an array
+        auto *vector = ValueImpl::create<ValueVector>();
+        parseItems(vector);
+        return vector;
+    }
+
+    /**
+     *  The offset in the input where parsing failed
+     *
+     *  @return size_t
+     */
+    size_t offset() const
+    {
+        return _current - _begin;
+    }
+
+    /**
+     *  Description of the reason why parsing failed
+     *
+     *  @return the reason, or a nullptr if parsing succeeded
+     */
+    const char *reason() const
+    {
+        return _reason;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -0,0 +1,73 @@
+/**
+ *  JsonSource.h
+ *
+ *  A json document together with the positions of all the
+ *  objects and arrays in it. Lazy values use this structural
+ *  index to decode a single level of the document at a time.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Class definition
+ */
+class JsonSource
+{
+public:
+    /**
+     *  Position of an object or array in the document
+     */
+    struct Container
+    {
+        /**
+         *  Offset of the opening brace or bracket
+         */
+        size_t begin;
+
+        /**
+         *  Offset just past the closing brace or bracket
+         */
+        size_t end;
+
+        /**
+         *  The number of containers nested inside this one
+         */
+        size_t descendants;
+    };
+
+    /**
+     *  The json document
+     */
+    const std::string json;
+
+    /**
+     *  All containers in the document, in the order in which they start,
+     *  so the first container nested in container n is found at n + 1
+     */
+    std::vector<Container> containers;
+
+    /**
+     *  Constructor
+     *
+     *  @param  json    the json document
+     */
+    JsonSource(std::string&& json) : json(std::move(json)) {}
+};
+
+/**
+ *  End namespace
+ */
+}
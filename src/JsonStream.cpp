@@ -0,0 +1,174 @@
+/**
+ *  JsonStream.cpp
+ *
+ *  Push parser for a stream of json documents
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/JsonStream.h"
+#include "JsonParser.h"
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Parse a complete document and report it
+ *
+ *  @param  data    start of the document
+ *  @param  size    size of the document
+ *  @param  offset  offset of the document in the stream
+ *  @return was the document valid?
+ */
+bool JsonStream::emit(const char *data, size_t size, size_t offset)
+{
+    // parse the document
+    Value value;
+    JsonParser parser(std::string_view(data, size));
+
+    // report the document if it was valid
+    if (parser.parse(value))
+    {
+        _callback(std::move(value));
+        return true;
+    }
+
+    // remember what went wrong
+    _error.offset = offset + parser.offset();
+    _error.reason = parser.reason();
+    return false;
+}
+
+/**
+ *  Complete the current document
+ *
+ *  @param  start   start of the document in the current chunk
+ *  @param  end     end of the document
+ *  @return was the document valid?
+ */
+bool JsonStream::complete(const char *start, const char *end)
+{
+    // the next document starts from scratch
+    _scalar = false;
+
+    // documents that lie completely inside the chunk are parsed in place
+    if (_buffer.empty()) return emit(start, end - start, _start);
+
+    // the document started in an earlier chunk, complete it in the buffer
+    _buffer.append(start, end);
+    bool valid = emit(_buffer.data(), _buffer.size(), _start);
+
+    // empty the buffer, but keep its memory for the next document
+    _buffer.clear();
+    return valid;
+}
+
+/**
+ *  Feed the next chunk of input
+ *
+ *  @param  data    the input
+ *  @param  size    size of the input
+ *  @return were all completed documents valid?
+ */
+bool JsonStream::parse(const char *data, size_t size)
+{
+    // were all documents valid, and where does the current document start?
+    bool valid = true;
+    const char *start = data;
+    const char *end = data + size;
+
+    // look for the end of every document
+    for (const char *current = data; current < end; ++current)
+    {
+        // inside a string we only look for the closing quote
+        if (_string)
+        {
+            // check for escape sequences and the end of the string
+            if (_escaped) _escaped = false;
+            else if (*current == '\\') _escaped = true;
+            else if (*current == '"') _string = false;
+
+            // a string can be a document on its own
+            if (!_string && _depth == 0) valid = complete(start, current + 1) && valid;
+            continue;
+        }
+
+        // numbers and literals end at whitespace or at the start of something else
+        bool whitespace = *current == ' ' || *current == '\n' || *current == '\r' || *current == '\t';
+        if (_scalar && (whitespace || *current == '"' || *current == '{' || *current == '[' || *current == '}' || *current == ']'))
+        {
+            valid = complete(start, current) && valid;
+        }
+
+        // whitespace between documents is skipped, anything else starts a new document
+        if (_depth == 0 && !_scalar)
+        {
+            if (whitespace) continue;
+            start = current;
+            _start = _processed + (current - data);
+        }
+
+        // keep track of the nesting
+        switch (*current)
+        {
+        case '"':
+            _string = true;
+            break;
+
+        case '{':
+        case '[':
+            ++_depth;
+            break;
+
+        case '}':
+        case ']':
+            // a container ends the document when it is the outermost one
+            if (_depth > 0) --_depth;
+            if (_depth == 0) valid = complete(start, current + 1) && valid;
+            break;
+
+        default:
+            // anything else outside a container is a number or literal
+            if (_depth == 0) _scalar = true;
+            break;
+        }
+    }
+
+    // keep the start of an incomplete document for the next chunk
+    if (_depth > 0 || _string || _scalar) _buffer.append(start, end);
+
+    // update the offset in the stream
+    _processed += size;
+    return valid;
+}
+
+/**
+ *  Signal the end of the input
+ *
+ *  @return was the input valid and complete?
+ */
+bool JsonStream::finish()
+{
+    // a number or literal at the very end is complete now
+    if (_scalar && !_string) return complete(_buffer.data(), _buffer.data());
+
+    // nothing is left, so all is fine
+    if (_depth == 0 && !_string) return true;
+
+    // the last document was cut off
+    _error.offset = _processed;
+    _error.reason = "unexpected end of input";
+
+    // start over, forget about the incomplete document
+    _buffer.clear();
+    _depth = 0;
+    _string = _escaped = false;
+    return false;
+}
+
+/**
+ *  End namespace
+ */
+}
@@ -0,0 +1,127 @@
+/**
+ *  JsonWriter.h
+ *
+ *  Helper functions to append json encoded
+ *  scalars and strings to an output buffer.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Writer class
+ */
+class JsonWriter
+{
+public:
+    /**
+     *  Append an integer
+     *
+     *  @param  output
+     *  @param  value
+     */
+    static void number(std::string& output, int64_t value)
+    {
+        // format the number on the stack and append it
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        output.append(buffer, result.ptr);
+    }
+
+    /**
+     *  Append a floating point number
+     *
+     *  The shortest representation that reads back to the same
+     *  number is used. Json has no notation for infinity and
+     *  not-a-number, so these are written as null.
+     *
+     *  @param  output
+     *  @param  value
+     */
+    static void number(std::string& output, double value)
+    {
+        // infinity and not-a-number can not be represented
+        if (!std::isfinite(value)) return (void)output.append("null", 4);
+
+        // format the number on the stack
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        output.append(buffer, result.ptr);
+
+        // make sure the number is read back as a double, and not an integer
+        for (const char *current = buffer; current < result.ptr; ++current) if (*current == '.' || *current == 'e') return;
+        output.append(".0", 2);
+    }
+
+    /**
+     *  Append a quoted and escaped string
+     *
+     *  @param  output
+     *  @param  data
+     *  @param  size
+     */
+    static void string(std::string& output, const char *data, size_t size)
+    {
+        // escape sequences for the control characters
+        static const char hex[] = "0123456789abcdef";
+
+        // the opening quote
+        output.push_back('"');
+
+        // append the string in runs of characters that need no escaping
+        const char *end = data + size;
+        while (data < end)
+        {
+            // find the next character that must be escaped
+            const char *current = data;
+            while (current < end && *current != '"' && *current != '\\' && (unsigned char)*current >= 0x20) ++current;
+
+            // append everything up to that character
+            output.append(data, current);
+            if (current == end) break;
+
+            // escape the character
+            switch (*current)
+            {
+                case '"':   output.append("\\\"", 2); break;
+                case '\\':  output.append("\\\\", 2); break;
+                case '\b':  output.append("\\b", 2); break;
+                case '\f':  output.append("\\f", 2); break;
+                case '\n':  output.append("\\n", 2); break;
+                case '\r':  output.append("\\r", 2); break;
+                case '\t':  output.append("\\t", 2); break;
+                default:
+                    // other control characters are written as a unicode escape
+                    output.append("\\u00", 4);
+                    output.push_back(hex[*current >> 4]);
+                    output.push_back(hex[*current & 0x0F]);
+                    break;
+            }
+
+            // continue after the escaped character
+            data = current + 1;
+        }
+
+        // the closing quote
+        output.push_back('"');
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
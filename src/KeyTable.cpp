@@ -0,0 +1,104 @@
+/**
+ *  KeyTable.cpp
+ *
+ *  Implementation file for the table of shared map keys
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/KeyTable.h"
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Maximum number of keys in the table, zero when keys are not shared
+ */
+static std::atomic<size_t> limit{0};
+
+/**
+ *  The keys and the lock that protects them
+ */
+namespace {
+struct Table
+{
+    std::shared_mutex lock;
+    std::unordered_set<std::string_view> keys;
+};
+}
+
+/**
+ *  The table, which is never destructed because
+ *  values in static variables may still use it
+ *
+ *  @return Table
+ */
+static Table &table()
+{
+    static Table *table = new Table();
+    return *table;
+}
+
+/**
+ *  Start sharing keys
+ *
+ *  @param  limit   maximum number of keys in the table
+ */
+void KeyTable::enable(size_t limit)
+{
+    Variant::limit.store(limit, std::memory_order_relaxed);
+}
+
+/**
+ *  Stop sharing keys, the keys that are already shared stay valid
+ */
+void KeyTable::disable()
+{
+    limit.store(0, std::memory_order_relaxed);
+}
+
+/**
+ *  Find or add a key
+ *
+ *  @param  key     the key to look up
+ *  @return the shared copy of the key, or a nullptr if keys are not shared
+ */
+const char *KeyTable::intern(std::string_view key)
+{
+    // nothing to do when the table is not used
+    size_t maximum = limit.load(std::memory_order_relaxed);
+    if (maximum == 0) return nullptr;
+
+    // most keys are already known, they only need a shared lock
+    Table &table = Variant::table();
+    {
+        std::shared_lock<std::shared_mutex> lock(table.lock);
+        auto iter = table.keys.find(key);
+        if (iter != table.keys.end()) return iter->data();
+    }
+
+    // another thread may have added the key in the meantime
+    std::unique_lock<std::shared_mutex> lock(table.lock);
+    auto iter = table.keys.find(key);
+    if (iter != table.keys.end()) return iter->data();
+
+    // do not add keys when the table is full
+    if (table.keys.size() >= maximum) return nullptr;
+
+    // add a copy of the key, which stays around forever
+    char *bytes = new char[key.size()];
+    key.copy(bytes, key.size());
+    return table.keys.emplace(bytes, key.size()).first->data();
+}
+
+/**
+ *  End namespace
+ */
+}
@@ -0,0 +1,359 @@
+/**
+ *  MsgPackParser.h
+ *
+ *  Parser that turns MessagePack data straight into Value objects.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include "../include/Value.h"
+#include "ValueVector.h"
+#include "ValueMap.h"
+#include <algorithm>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Parser class
+ */
+class MsgPackParser
+{
+private:
+    /**
+     *  Containers can not be nested deeper than this
+     */
+    static const size_t maxDepth = 1024;
+
+    /**
+     *  The start of the input, the current position and the end of the input
+     */
+    const unsigned char *_begin;
+    const unsigned char *_current;
+    const unsigned char *_end;
+
+    /**
+     *  Description of the error, if parsing failed
+     */
+    const char *_reason = nullptr;
+
+    /**
+     *  The current nesting depth
+     */
+    size_t _depth = 0;
+
+    /**
+     *  Buffer for the key of a map member
+     */
+    std::string _key;
+
+    /**
+     *  Record an error at the current position
+     *
+     *  @param  reason  description of the error
+     *  @return always false
+     */
+    bool fail(const char *reason)
+    {
+        _reason = reason;
+        return false;
+    }
+
+    /**
+     *  Read a big endian unsigned number
+     *
+     *  @param  bytes   size of the number
+     *  @param  result  the number that was read
+     *  @return were there enough bytes?
+     */
+    bool read(size_t bytes, uint64_t& result)
+    {
+        // the number must fit in the input
+        if ((size_t)(_end - _current) < bytes) return fail("unexpected end of input");
+
+        // read the number, most significant byte first
+        result = 0;
+        for (size_t i = 0; i < bytes; ++i) result = (result << 8) | *_current++;
+        return true;
+    }
+
+    /**
+     *  Read the size of a string, array or map
+     *
+     *  @param  bytes   size of the size field
+     *  @param  result  the size that was read
+     *  @return was the size valid?
+     */
+    bool readSize(size_t bytes, size_t& result)
+    {
+        // read the size
+        uint64_t size;
+        if (!read(bytes, size)) return false;
+
+        // every byte and element takes up at least one byte of input, which
+        // keeps us from reserving memory for data that does not exist
+        if (size > (size_t)(_end - _current)) return fail("unexpected end of input");
+
+        // expose the size
+        result = size;
+        return true;
+    }
+
+    /**
+     *  Parse a string
+     *
+     *  @param  size    size of the string
+     *  @param  result
+     *  @return was the string complete?
+     */
+    bool parseString(size_t size, Value& result)
+    {
+        // the string must fit in the input
+        if (size > (size_t)(_end - _current)) return fail("unexpected end of input");
+
+        // copy the string
+        result = Value((const char *)_current, size);
+        _current += size;
+        return true;
+    }
+
+    /**
+     *  Parse the items of an array
+     *
+     *  @param  size    number of items
+     *  @param  result
+     *  @return was this a valid array?
+     */
+    bool parseArray(size_t size, Value& result)
+    {
+        // items are added straight into the vector
+        auto *vector = ValueImpl::create<ValueVector>();
+        result = Value(vector);
+
+        // allocate the storage once, every item takes at least one byte of input
+        vector->reserve(std::min(size, size_t(_end - _current)));
+
+        // parse all the items
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (!parseValue(vector->append())) return false;
+        }
+
+        // the array is complete
+        return true;
+    }
+
+    /**
+     *  Parse the members of a map
+     *
+     *  @param  size    number of members
+     *  @param  result
+     *  @return was this a valid map?
+     */
+    bool parseMap(size_t size, Value& result)
+    {
+        // members are added straight into the map
+        auto *map = ValueImpl::create<ValueMap>();
+        result = Value(map);
+
+        // parse all the members
+        for (size_t i = 0; i < size; ++i)
+        {
+            // parse the key, which must be a string
+            if (!parseKey()) return false;
+
+            // parse the value straight into the map
+            if (!parseValue(map->member(_key))) return false;
+        }
+
+        // the map is complete
+        return true;
+    }
+
+    /**
+     *  Parse the key of a map member into the key buffer
+     *
+     *  @return was this a valid key?
+     */
+    bool parseKey()
+    {
+        // check the type of the key
+        if (_current == _end) return fail("unexpected end of input");
+        uint8_t type = *_current++;
+
+        // find out the size of the string
+        size_t size;
+        if (type >= 0xa0 && type <= 0xbf) size = type & 0x1f;
+        else if (type == 0xd9 || type == 0xc4) { if (!readSize(1, size)) return false; }
+        else if (type == 0xda || type == 0xc5) { if (!readSize(2, size)) return false; }
+        else if (type == 0xdb || type == 0xc6) { if (!readSize(4, size)) return false; }
+        else { --_current; return fail("map key is not a string"); }
+
+        // the string must fit in the input
+        if (size > (size_t)(_end - _current)) return fail("unexpected end of input");
+
+        // copy the key
+        _key.assign((const char *)_current, size);
+        _current += size;
+        return true;
+    }
+
+    /**
+     *  Parse an array or map, while keeping track of the nesting depth
+     *
+     *  @param  map     is this a map?
+     *  @param  size    number of items or members
+     *  @param  result
+     *  @return was this a valid container?
+     */
+    bool parseContainer(bool map, size_t size, Value& result)
+    {
+        // prevent unbounded recursion
+        if (_depth == maxDepth) return fail("nesting too deep");
+
+        // parse the container
+        ++_depth;
+        bool success = map ? parseMap(size, result) : parseArray(size, result);
+        --_depth;
+        return success;
+    }
+
+    /**
+     *  Parse a value
+     *
+     *  Integers in the formats of up to 32 bits become 32 bit integers,
+     *  except for unsigned 32 bit integers, which may not fit. These
+     *  and the 64 bit formats become 64 bit integers. Both floating
+     *  point formats become doubles, and binary data becomes a string.
+     *
+     *  @param  result
+     *  @return was this a valid value?
+     */
+    bool parseValue(Value& result)
+    {
+        // the type byte is always needed
+        if (_current == _end) return fail("unexpected end of input");
+        uint8_t type = *_current++;
+
+        // the compact formats hold their value or size in the type byte
+        if (type <= 0x7f) { result = (int32_t)type; return true; }
+        if (type >= 0xe0) { result = (int32_t)(int8_t)type; return true; }
+        if (type >= 0xa0 && type <= 0xbf) return parseString(type & 0x1f, result);
+        if (type >= 0x90 && type <= 0x9f) return parseContainer(false, type & 0x0f, result);
+        if (type >= 0x80 && type <= 0x8f) return parseContainer(true, type & 0x0f, result);
+
+        // the other formats are followed by a number or a size
+        uint64_t number;
+        size_t size;
+        switch (type)
+        {
+            case 0xc0:  result = Value(); return true;
+            case 0xc2:  result = false; return true;
+            case 0xc3:  result = true; return true;
+            case 0xcc:  if (!read(1, number)) return false; result = (int32_t)number; return true;
+            case 0xcd:  if (!read(2, number)) return false; result = (int32_t)number; return true;
+            case 0xce:  if (!read(4, number)) return false; result = (int64_t)number; return true;
+            case 0xcf:
+                // numbers that do not fit in a signed integer become doubles
+                if (!read(8, number)) return false;
+                if (number > (uint64_t)INT64_MAX) result = (double)number;
+                else result = (int64_t)number;
+                return true;
+            case 0xd0:  if (!read(1, number)) return false; result = (int32_t)(int8_t)number; return true;
+            case 0xd1:  if (!read(2, number)) return false; result = (int32_t)(int16_t)number; return true;
+            case 0xd2:  if (!read(4, number)) return false; result = (int32_t)number; return true;
+            case 0xd3:  if (!read(8, number)) return false; result = (int64_t)number; return true;
+            case 0xca:
+            {
+                // copy the bits into a float
+                if (!read(4, number)) return false;
+                uint32_t bits = number;
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+                result = (double)value;
+                return true;
+            }
+            case 0xcb:
+            {
+                // copy the bits into a double
+                if (!read(8, number)) return false;
+                double value;
+                std::memcpy(&value, &number, sizeof(value));
+                result = value;
+                return true;
+            }
+            case 0xc4:
+            case 0xd9:  return readSize(1, size) && parseString(size, result);
+            case 0xc5:
+            case 0xda:  return readSize(2, size) && parseString(size, result);
+            case 0xc6:
+            case 0xdb:  return readSize(4, size) && parseString(size, result);
+            case 0xdc:  return readSize(2, size) && parseContainer(false, size, result);
+            case 0xdd:  return readSize(4, size) && parseContainer(false, size, result);
+            case 0xde:  return readSize(2, size) && parseContainer(true, size, result);
+            case 0xdf:  return readSize(4, size) && parseContainer(true, size, result);
+            default:    --_current; return fail("unsupported type");
+        }
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  @param  data    the MessagePack data to parse
+     */
+    MsgPackParser(std::string_view data) :
+        _begin((const unsigned char *)data.data()),
+        _current((const unsigned char *)data.data()),
+        _end((const unsigned char *)data.data() + data.size()) {}
+
+    /**
+     *  Parse the data
+     *
+     *  @param  result  the parsed value
+     *  @return was the data valid MessagePack?
+     */
+    bool parse(Value& result)
+    {
+        // parse the value, nothing may follow it
+        if (!parseValue(result)) return false;
+        return _current == _end || fail("unexpected data after value");
+    }
+
+    /**
+     *  The offset in the input where parsing failed
+     *
+     *  @return size_t
+     */
+    size_t offset() const
+    {
+        return _current - _begin;
+    }
+
+    /**
+     *  Description of the reason why parsing failed
+     *
+     *  @return the reason, or a nullptr if parsing succeeded
+     */
+    const char *reason() const
+    {
+        return _reason;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
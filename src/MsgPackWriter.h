@@ -0,0 +1,161 @@
+/**
+ *  MsgPackWriter.h
+ *
+ *  Helper functions to append MessagePack encoded
+ *  values and headers to an output buffer.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Writer class
+ */
+class MsgPackWriter
+{
+private:
+    /**
+     *  Append a type byte followed by a big endian number
+     *
+     *  @param  output
+     *  @param  type    the type byte
+     *  @param  value   the number to append
+     *  @param  bytes   the number of bytes to use for the number
+     */
+    static void append(std::string& output, uint8_t type, uint64_t value, size_t bytes)
+    {
+        // the type byte comes first
+        char buffer[9] = { (char)type };
+
+        // followed by the number, most significant byte first
+        for (size_t i = 0; i < bytes; ++i) buffer[bytes - i] = (char)(value >> (8 * i));
+        output.append(buffer, bytes + 1);
+    }
+
+public:
+    /**
+     *  Append null
+     *
+     *  @param  output
+     */
+    static void null(std::string& output)
+    {
+        output.push_back((char)0xc0);
+    }
+
+    /**
+     *  Append a boolean
+     *
+     *  @param  output
+     *  @param  value
+     */
+    static void boolean(std::string& output, bool value)
+    {
+        output.push_back((char)(value ? 0xc3 : 0xc2));
+    }
+
+    /**
+     *  Append a 32 bit integer, in the most compact format
+     *
+     *  @param  output
+     *  @param  value
+     */
+    static void number(std::string& output, int32_t value)
+    {
+        if (value >= -32 && value <= 127) output.push_back((char)value);
+        else if (value >= INT8_MIN && value <= INT8_MAX) append(output, 0xd0, (uint8_t)value, 1);
+        else if (value >= INT16_MIN && value <= INT16_MAX) append(output, 0xd1, (uint16_t)value, 2);
+        else append(output, 0xd2, (uint32_t)value, 4);
+    }
+
+    /**
+     *  Append a 64 bit integer
+     *
+     *  This always uses the 64 bit format, so that the
+     *  value is decoded as a 64 bit integer again.
+     *
+     *  @param  output
+     *  @param  value
+     */
+    static void number(std::string& output, int64_t value)
+    {
+        append(output, 0xd3, (uint64_t)value, 8);
+    }
+
+    /**
+     *  Append a floating point number
+     *
+     *  @param  output
+     *  @param  value
+     */
+    static void number(std::string& output, double value)
+    {
+        // copy the bits of the number
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        append(output, 0xcb, bits, 8);
+    }
+
+    /**
+     *  Append a string
+     *
+     *  @param  output
+     *  @param  data
+     *  @param  size
+     */
+    static void string(std::string& output, const char *data, size_t size)
+    {
+        // append the header, in the most compact format
+        if (size <= 31) output.push_back((char)(0xa0 | size));
+        else if (size <= UINT8_MAX) append(output, 0xd9, size, 1);
+        else if (size <= UINT16_MAX) append(output, 0xda, size, 2);
+        else append(output, 0xdb, size, 4);
+
+        // followed by the string itself
+        output.append(data, size);
+    }
+
+    /**
+     *  Append the header of an array, the items must follow it
+     *
+     *  @param  output
+     *  @param  size    number of items
+     */
+    static void array(std::string& output, size_t size)
+    {
+        if (size <= 15) output.push_back((char)(0x90 | size));
+        else if (size <= UINT16_MAX) append(output, 0xdc, size, 2);
+        else append(output, 0xdd, size, 4);
+    }
+
+    /**
+     *  Append the header of a map, the keys and values must follow it
+     *
+     *  @param  output
+     *  @param  size    number of members
+     */
+    static void map(std::string& output, size_t size)
+    {
+        if (size <= 15) output.push_back((char)(0x80 | size));
+        else if (size <= UINT16_MAX) append(output, 0xde, size, 2);
+        else append(output, 0xdf, size, 4);
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
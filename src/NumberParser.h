@@ -0,0 +1,134 @@
+/**
+ *  NumberParser.h
+ *
+ *  Helper functions to read numbers from strings. They do not
+ *  depend on the locale, and never throw exceptions. They accept
+ *  what strtol() and strtod() accept in the C locale: leading
+ *  whitespace, a sign, and for floating point numbers also
+ *  hexadecimal numbers, infinity and nan. Integers are always
+ *  read in base 10, just like std::stoll() does.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Parser class
+ */
+class NumberParser
+{
+private:
+    /**
+     *  Skip whitespace
+     *
+     *  @param  current
+     *  @param  end
+     *  @return the first character that is not whitespace
+     */
+    static const char *skip(const char *current, const char *end)
+    {
+        while (current < end && (*current == ' ' || (*current >= '\t' && *current <= '\r'))) ++current;
+        return current;
+    }
+
+    /**
+     *  Read a number from the start of a string
+     *
+     *  Leading whitespace and a plus sign are accepted, just like strtol()
+     *  and strtod() do. Numbers that do not fit in the type are rejected.
+     *
+     *  @param  input   the string
+     *  @param  result  the number that was read
+     *  @return the character after the number, or a nullptr if there is no number
+     */
+    template <typename T>
+    static const char *read(std::string_view input, T& result)
+    {
+        // skip leading whitespace
+        const char *end = input.data() + input.size();
+        const char *current = skip(input.data(), end);
+
+        // from_chars() only knows about the minus sign
+        if (current < end && *current == '+' && ++current < end && *current == '-') return nullptr;
+
+        // strtod() also reads hexadecimal numbers, from_chars() wants them without their prefix
+        if constexpr (std::is_floating_point<T>::value)
+        {
+            bool negative = current < end && *current == '-';
+            const char *digits = current + negative;
+            if (end - digits > 2 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X') && digits[2] != '-')
+            {
+                // without hexadecimal digits, strtod() reads the zero in front of the x
+                auto converted = std::from_chars(digits + 2, end, result, std::chars_format::hex);
+                if (converted.ec == std::errc())
+                {
+                    result = negative ? -result : result;
+                    return converted.ptr;
+                }
+            }
+        }
+
+        // read the number
+        auto converted = std::from_chars(current, end, result);
+        return converted.ec == std::errc() ? converted.ptr : nullptr;
+    }
+
+public:
+    /**
+     *  Read the number at the start of a string
+     *
+     *  Anything after the number is ignored. When the string does
+     *  not start with a number, or the number does not fit, zero
+     *  is returned.
+     *
+     *  @param  input
+     *  @return T
+     */
+    template <typename T>
+    static T prefix(std::string_view input)
+    {
+        T result;
+        return read(input, result) ? result : 0;
+    }
+
+    /**
+     *  Read a string that holds nothing but a number
+     *
+     *  Whitespace around the number is allowed. The result is
+     *  left alone when the string does not hold a number.
+     *
+     *  @param  input
+     *  @param  result
+     *  @return was the number read?
+     */
+    template <typename T>
+    static bool complete(std::string_view input, T& result)
+    {
+        // read the number, and make sure nothing follows it
+        T number;
+        const char *end = read(input, number);
+        if (end == nullptr || skip(end, input.data() + input.size()) != input.data() + input.size()) return false;
+
+        // expose the number
+        result = number;
+        return true;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
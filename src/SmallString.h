@@ -0,0 +1,303 @@
+/**
+ *  SmallString.h
+ *
+ *  Compact string for string values and map keys. Strings that fit
+ *  in the object are stored inline, longer strings are allocated
+ *  from a memory resource, or shared with the key table.
+ *
+ *  Unlike a std::pmr::string it does not store the memory resource
+ *  in every object, and it does not reserve room for a terminating
+ *  null character, so more strings fit inline in less space.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <memory_resource>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Class definition
+ */
+template <size_t capacity>
+class SmallString
+{
+public:
+    /**
+     *  The allocator, so that containers pass their memory resource
+     */
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+private:
+    /**
+     *  What is stored in front of the bytes of a long string
+     */
+    struct Header
+    {
+        std::pmr::memory_resource *resource;
+    };
+
+    /**
+     *  Size of the string
+     *  @var    uint64_t
+     */
+    uint64_t _size : 63;
+
+    /**
+     *  Does a long string live in the key table?
+     *  @var    uint64_t
+     */
+    uint64_t _shared : 1;
+
+    /**
+     *  The bytes, inline for short strings
+     */
+    union
+    {
+        char _inline[capacity];
+        const char *_external;
+    };
+
+    /**
+     *  Is the string stored inline?
+     *  @return bool
+     */
+    bool inlined() const
+    {
+        return _size <= capacity;
+    }
+
+    /**
+     *  Store a copy of a string
+     *
+     *  @param  value       the string to copy
+     *  @param  resource    where to allocate long strings
+     */
+    void assign(std::string_view value, std::pmr::memory_resource *resource)
+    {
+        // short strings are copied inline
+        _size = value.size();
+        _shared = false;
+        if (inlined())
+        {
+            value.copy(_inline, value.size());
+            return;
+        }
+
+        // long strings are preceded by the resource they came from
+        auto *header = static_cast<Header *>(resource->allocate(sizeof(Header) + value.size(), alignof(Header)));
+        header->resource = resource;
+        std::memcpy(header + 1, value.data(), value.size());
+        _external = reinterpret_cast<const char *>(header + 1);
+    }
+
+    /**
+     *  Refer to the same bytes as a string in the key table
+     *
+     *  @param  that
+     */
+    void share(const SmallString& that)
+    {
+        _size = that._size;
+        _shared = true;
+        _external = that._external;
+    }
+
+    /**
+     *  Take over the bytes of another string, which is left empty
+     *
+     *  @param  that
+     */
+    void steal(SmallString& that)
+    {
+        // the inline bytes are copied, a pointer is enough for the rest
+        _size = that._size;
+        _shared = that._shared;
+        if (inlined()) std::memcpy(_inline, that._inline, capacity);
+        else _external = that._external;
+
+        // the other string no longer owns anything
+        that._size = 0;
+        that._shared = false;
+    }
+
+    /**
+     *  The resource a long string was allocated from
+     *
+     *  @return the memory resource
+     */
+    std::pmr::memory_resource *resource() const
+    {
+        return (reinterpret_cast<const Header *>(_external) - 1)->resource;
+    }
+
+    /**
+     *  Give the memory of a long string back
+     */
+    void release()
+    {
+        // only long strings that we own were allocated
+        if (inlined() || _shared) return;
+
+        // the header tells us where they came from
+        auto *header = const_cast<Header *>(reinterpret_cast<const Header *>(_external) - 1);
+        header->resource->deallocate(header, sizeof(Header) + _size, alignof(Header));
+    }
+
+    /**
+     *  Empty constructor, for shared()
+     */
+    SmallString() : _size(0), _shared(false) {}
+
+public:
+    /**
+     *  Constructor
+     *
+     *  @param  value       the string to copy
+     *  @param  allocator   where to allocate long strings
+     */
+    SmallString(std::string_view value, const allocator_type& allocator = {})
+    {
+        assign(value, allocator.resource());
+    }
+
+    /**
+     *  Copy constructor
+     *
+     *  @param  that        the string to copy
+     *  @param  allocator   where to allocate long strings
+     */
+    SmallString(const SmallString& that, const allocator_type& allocator = {})
+    {
+        // strings in the key table do not have to be copied
+        if (that._shared) share(that);
+        else assign(that, allocator.resource());
+    }
+
+    /**
+     *  Move constructor
+     *
+     *  @param  that
+     */
+    SmallString(SmallString&& that) noexcept
+    {
+        steal(that);
+    }
+
+    /**
+     *  Move constructor, for containers that use a memory resource
+     *
+     *  @param  that        the string to move
+     *  @param  allocator   where to allocate long strings
+     */
+    SmallString(SmallString&& that, const allocator_type& allocator)
+    {
+        // a long string from a different resource must be copied
+        if (that.inlined() || that._shared || that.resource() == allocator.resource()) steal(that);
+        else assign(that, allocator.resource());
+    }
+
+    /**
+     *  Strings are only created, never modified
+     */
+    SmallString& operator=(const SmallString& that) = delete;
+
+    /**
+     *  Destructor
+     */
+    ~SmallString()
+    {
+        release();
+    }
+
+    /**
+     *  Is a string short enough to be stored inline?
+     *
+     *  @param  size    size of the string
+     *  @return bool
+     */
+    static bool fits(size_t size)
+    {
+        return size <= capacity;
+    }
+
+    /**
+     *  Refer to a string that lives in the key table
+     *
+     *  @param  value       a string returned by KeyTable::intern()
+     *  @return SmallString
+     */
+    static SmallString shared(std::string_view value)
+    {
+        // short strings are stored inline anyway
+        if (fits(value.size())) return SmallString(value);
+
+        // long strings refer to the table
+        SmallString result;
+        result._size = value.size();
+        result._shared = true;
+        result._external = value.data();
+        return result;
+    }
+
+    /**
+     *  The bytes of the string
+     *  @return const char *
+     */
+    const char *data() const
+    {
+        return inlined() ? _inline : _external;
+    }
+
+    /**
+     *  The size of the string
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     *  The string, without copying it
+     *  @return std::string_view
+     */
+    operator std::string_view () const
+    {
+        return std::string_view(data(), _size);
+    }
+
+    /**
+     *  Compare with another string
+     *
+     *  Strings that share their bytes, for example because they
+     *  both come from the key table, are equal without comparing
+     *  the bytes.
+     *
+     *  @param  that
+     *  @return bool
+     */
+    bool operator==(std::string_view that) const
+    {
+        // the sizes are compared first, and then the addresses
+        if (_size != that.size()) return false;
+        const char *bytes = data();
+        return _size == 0 || bytes == that.data() || std::memcmp(bytes, that.data(), _size) == 0;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
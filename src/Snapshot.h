@@ -0,0 +1,167 @@
+/**
+ *  Snapshot.h
+ *
+ *  The binary snapshot format, that can be read in place.
+ *
+ *  A snapshot starts with a header, followed by the slot of the
+ *  root value. Every value is described by a sixteen byte slot:
+ *  scalars are stored in the slot itself, strings and containers
+ *  refer to their data through an offset from the start of the
+ *  snapshot. Arrays are stored as a list of slots, maps as a list
+ *  of key and value slots in insertion order, followed by the
+ *  positions of the members sorted by key. Every string is stored
+ *  only once. All numbers use the byte order of the machine that
+ *  wrote the snapshot, the header is used to check that it matches.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+
+#include <sys/mman.h>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Description of a single value
+ */
+struct SnapshotSlot
+{
+    /**
+     *  The ValueType of the value
+     */
+    uint32_t type;
+
+    /**
+     *  Number of bytes in a string, or elements in a container
+     */
+    uint32_t size;
+
+    /**
+     *  The scalar value, or the offset of the data
+     */
+    union
+    {
+        int64_t integer;
+        double number;
+        uint64_t offset;
+    };
+};
+
+/**
+ *  Description of a map member
+ */
+struct SnapshotMember
+{
+    SnapshotSlot key;
+    SnapshotSlot value;
+};
+
+/**
+ *  Class definition
+ */
+class Snapshot
+{
+private:
+    /**
+     *  The snapshot data
+     */
+    const char *_data;
+    size_t _size;
+
+    /**
+     *  Was the data mapped by us?
+     */
+    bool _mapped;
+
+public:
+    /**
+     *  The first bytes of every snapshot, and the number used to check the byte order
+     */
+    static constexpr char magic[8] = { 'V', 'A', 'R', 'S', 'N', 'A', 'P', 1 };
+    static constexpr uint64_t order = 0x0102030405060708;
+
+    /**
+     *  Size of the header: the magic bytes and the byte order
+     */
+    static constexpr size_t header = 16;
+
+    /**
+     *  Constructor
+     *
+     *  @param  data    start of the snapshot
+     *  @param  size    size of the snapshot
+     *  @param  mapped  should the data be unmapped when we are destructed?
+     */
+    Snapshot(const char *data, size_t size, bool mapped) : _data(data), _size(size), _mapped(mapped) {}
+
+    /**
+     *  No copying, the mapping is owned by one object
+     */
+    Snapshot(const Snapshot& that) = delete;
+
+    /**
+     *  Destructor
+     */
+    ~Snapshot()
+    {
+        if (_mapped) munmap((void *)_data, _size);
+    }
+
+    /**
+     *  Is this a snapshot we can read?
+     *
+     *  @return bool
+     */
+    bool valid() const
+    {
+        // the data must be aligned and hold at least the header and the root
+        if ((uintptr_t)_data % alignof(SnapshotSlot) != 0 || _size < header + sizeof(SnapshotSlot)) return false;
+
+        // check the magic bytes and the byte order
+        uint64_t check;
+        std::memcpy(&check, _data + sizeof(magic), sizeof(check));
+        return std::memcmp(_data, magic, sizeof(magic)) == 0 && check == order;
+    }
+
+    /**
+     *  The slot of the root value
+     *
+     *  @return SnapshotSlot
+     */
+    const SnapshotSlot *root() const
+    {
+        return reinterpret_cast<const SnapshotSlot *>(_data + header);
+    }
+
+    /**
+     *  Look up data in the snapshot
+     *
+     *  @param  offset  offset of the data
+     *  @param  size    number of bytes needed
+     *  @return the data, or a nullptr if it does not fit in the snapshot
+     */
+    const char *at(uint64_t offset, uint64_t size) const
+    {
+        // the data must fit
+        if (offset > _size || size > _size - offset) return nullptr;
+
+        // expose the data
+        return _data + offset;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -0,0 +1,215 @@
+/**
+ *  SnapshotWriter.h
+ *
+ *  Class that writes Values in the binary snapshot format.
+ *
+ *  Elements are written before the container that holds them,
+ *  so every value can be appended to the output in one go.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include "../include/Value.h"
+#include "Snapshot.h"
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Writer class
+ */
+class SnapshotWriter
+{
+private:
+    /**
+     *  The output buffer
+     */
+    std::string &_output;
+
+    /**
+     *  The strings that were already written, and their offsets
+     */
+    std::unordered_map<std::string, uint64_t> _strings;
+
+    /**
+     *  Was a string or container too large for a slot?
+     */
+    bool _oversized = false;
+
+    /**
+     *  Check that a size fits in a slot
+     *
+     *  @param  size    number of bytes or elements
+     *  @return bool
+     */
+    bool fits(size_t size)
+    {
+        // remember when it does not, the snapshot is then useless
+        if (size <= UINT32_MAX) return true;
+        _oversized = true;
+        return false;
+    }
+
+    /**
+     *  Append raw data, aligned for slots
+     *
+     *  @param  data
+     *  @param  size
+     *  @return offset of the data
+     */
+    uint64_t append(const void *data, size_t size)
+    {
+        // pad the output up to the alignment of the slots
+        _output.resize((_output.size() + alignof(SnapshotSlot) - 1) & ~(alignof(SnapshotSlot) - 1));
+
+        // append the data
+        uint64_t offset = _output.size();
+        _output.append((const char *)data, size);
+        return offset;
+    }
+
+    /**
+     *  The string a slot refers to
+     *
+     *  @param  slot
+     *  @return std::string_view
+     */
+    std::string_view string(const SnapshotSlot& slot) const
+    {
+        return std::string_view(_output).substr(slot.offset, slot.size);
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  @param  output  buffer to write to, it should be empty
+     */
+    SnapshotWriter(std::string& output) : _output(output) {}
+
+    /**
+     *  Write a value
+     *
+     *  @param  value
+     *  @return the slot describing the value
+     */
+    SnapshotSlot value(const Value& value)
+    {
+        // scalars are stored in the slot itself
+        SnapshotSlot slot = { (uint32_t)value._type, 0, {} };
+        switch (value._type)
+        {
+            case ValueNullType:     slot.integer = 0; return slot;
+            case ValueBoolType:     slot.integer = value._bool; return slot;
+            case ValueInt32Type:    slot.integer = value._int32; return slot;
+            case ValueInt64Type:    slot.integer = value._int64; return slot;
+            case ValueDoubleType:   slot.number = value._double; return slot;
+            default:                return value._impl->toSnapshot(*this);
+        }
+    }
+
+    /**
+     *  Write a string, every string is only written once
+     *
+     *  @param  data
+     *  @param  size
+     *  @return the slot describing the string
+     */
+    SnapshotSlot string(const char *data, size_t size)
+    {
+        // the size must fit in the slot
+        if (!fits(size)) return SnapshotSlot{ ValueNullType, 0, {} };
+
+        // write the string if we did not see it before
+        auto result = _strings.emplace(std::string(data, size), 0);
+        if (result.second)
+        {
+            result.first->second = _output.size();
+            _output.append(data, size);
+        }
+
+        // describe the string
+        SnapshotSlot slot = { ValueStringType, (uint32_t)size, {} };
+        slot.offset = result.first->second;
+        return slot;
+    }
+
+    /**
+     *  Write an array
+     *
+     *  @param  items   the slots of the items
+     *  @return the slot describing the array
+     */
+    SnapshotSlot array(const std::vector<SnapshotSlot>& items)
+    {
+        // the size must fit in the slot
+        if (!fits(items.size())) return SnapshotSlot{ ValueNullType, 0, {} };
+
+        // write the items
+        SnapshotSlot slot = { ValueVectorType, (uint32_t)items.size(), {} };
+        slot.offset = append(items.data(), items.size() * sizeof(SnapshotSlot));
+        return slot;
+    }
+
+    /**
+     *  Write a map
+     *
+     *  @param  members the slots of the keys and values
+     *  @return the slot describing the map
+     */
+    SnapshotSlot map(const std::vector<SnapshotMember>& members)
+    {
+        // the size must fit in the slot
+        if (!fits(members.size())) return SnapshotSlot{ ValueNullType, 0, {} };
+
+        // sort the positions of the members by key
+        std::vector<uint32_t> sorted(members.size());
+        for (size_t i = 0; i < sorted.size(); ++i) sorted[i] = i;
+        std::sort(sorted.begin(), sorted.end(), [this, &members](uint32_t a, uint32_t b) {
+            return string(members[a].key) < string(members[b].key);
+        });
+
+        // write the members, followed by their sorted positions
+        SnapshotSlot slot = { ValueMapType, (uint32_t)members.size(), {} };
+        slot.offset = append(members.data(), members.size() * sizeof(SnapshotMember));
+        _output.append((const char *)sorted.data(), sorted.size() * sizeof(uint32_t));
+        return slot;
+    }
+
+    /**
+     *  Write a complete snapshot
+     *
+     *  @param  root    the value to write
+     *  @return false if a string or container holds more than 2^32-1 bytes or elements
+     */
+    bool write(const Value& root)
+    {
+        // write the header, and leave room for the root
+        _output.append(Snapshot::magic, sizeof(Snapshot::magic));
+        _output.append((const char *)&Snapshot::order, sizeof(Snapshot::order));
+        _output.append(sizeof(SnapshotSlot), '\0');
+
+        // write the root, and store its slot right after the header
+        SnapshotSlot slot = value(root);
+        std::memcpy(&_output[Snapshot::header], &slot, sizeof(slot));
+        return !_oversized;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -9,77 +9,444 @@
 
 #include "../include/Value.h"
 #include "../include/ValueMember.h"
-#include "ValueBool.h"
-#include "ValueInt32.h"
-#include "ValueInt64.h"
-#include "ValueDouble.h"
 #include "ValueString.h"
-#include "ValueNull.h"
 #include "ValueVector.h"
 #include "ValueMap.h"
+#include "ValueLazy.h"
+#include "JsonSource.h"
+#include "JsonParser.h"
+#include "JsonWriter.h"
+#include "MsgPackParser.h"
+#include "MsgPackWriter.h"
+#include "CborParser.h"
+#include "CborWriter.h"
+#include "Hash.h"
+#include "Snapshot.h"
+#include "SnapshotWriter.h"
+#include "ValueSnapshot.h"
 
 #include <json-c/json.h>
 
+#include <cmath>
+#include <type_traits>
+#include <limits>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 /**
  *  Namespace
  */
 namespace Variant {
 
+/**
+ *  The value we expose for elements that do not exist
+ */
+static const Value null;
+
 /**
  *  Copy constructor
  */
-Value::Value(const Value& that) : _impl(that._impl->clone()) {}
+Value::Value(const Value& that) : _type(that._type)
+{
+    // copy the inline value, or share the implementation
+    switch (_type)
+    {
+        case ValueNullType:     break;
+        case ValueBoolType:     _bool = that._bool; break;
+        case ValueInt32Type:    _int32 = that._int32; break;
+        case ValueInt64Type:    _int64 = that._int64; break;
+        case ValueDoubleType:   _double = that._double; break;
+        default:                _impl = that._impl->share(); break;
+    }
+}
 
 /**
  *  Move constructor
  */
-Value::Value(Value&& that) : _impl(std::move(that._impl)) {}
+Value::Value(Value&& that) noexcept : _type(ValueNullType)
+{
+    steal(that);
+}
+
+/**
+ *  Vectors of values only move their items when they grow if that can not throw
+ */
+static_assert(std::is_nothrow_move_constructible<Value>::value, "values must be nothrow movable");
+static_assert(std::is_nothrow_move_assignable<Value>::value, "values must be nothrow movable");
+
+/**
+ *  Destructor
+ */
+Value::~Value()
+{
+    release();
+}
 
 /**
  *  Null constructor
  */
-Value::Value() : _impl(new ValueNull()) {}
-Value::Value(std::nullptr_t value) : _impl(new ValueNull()) {}
+Value::Value() : _type(ValueNullType) {}
+Value::Value(std::nullptr_t value) : _type(ValueNullType) {}
 
 /**
  *  Boolean constructor
  */
-Value::Value(bool value) : _impl(new ValueBool(value)) {}
+Value::Value(bool value) : _type(ValueBoolType), _bool(value) {}
 
 /**
  *  Numeric constructor
  *  @param  value
  */
-Value::Value(int32_t value) : _impl(new ValueInt32(value)) {}
-Value::Value(int64_t value) : _impl(new ValueInt64(value)) {}
-Value::Value(double value) : _impl(new ValueDouble(value)) {}
+Value::Value(int32_t value) : _type(ValueInt32Type), _int32(value) {}
+Value::Value(int64_t value) : _type(ValueInt64Type), _int64(value) {}
+Value::Value(double value) : _type(ValueDoubleType), _double(value) {}
 
 /**
  *  String constructor
  *  @param  value
  */
-Value::Value(const char* value) : _impl(new ValueString(value)) {}
-Value::Value(const char* value, size_t length) : _impl(new ValueString(value, length)) {}
-Value::Value(const std::string& value) : _impl(new ValueString(value)) {}
-Value::Value(std::string&& value) : _impl(new ValueString(std::move(value))) {}
+Value::Value(const char* value) : _type(ValueStringType), _impl(ValueImpl::create<ValueString>(value)) {}
+Value::Value(const char* value, size_t length) : _type(ValueStringType), _impl(ValueImpl::create<ValueString>(value, length)) {}
+Value::Value(const std::string& value) : _type(ValueStringType), _impl(ValueImpl::create<ValueString>(value)) {}
+Value::Value(std::string&& value) : _type(ValueStringType), _impl(ValueImpl::create<ValueString>(std::move(value))) {}
+Value::Value(std::string_view value) : _type(ValueStringType), _impl(ValueImpl::create<ValueString>(value)) {}
 
 /**
  *  Vector constructor
  *  @param  value
  */
-Value::Value(const std::vector<Value>& value) : _impl(new ValueVector(value)) {}
-Value::Value(std::vector<Value>&& value) : _impl(new ValueVector(std::move(value))) {}
-Value::Value(const std::initializer_list<Value>& value) : _impl(new ValueVector(value)) {}
+Value::Value(const std::vector<Value>& value) : _type(ValueVectorType), _impl(ValueImpl::create<ValueVector>(value)) {}
+Value::Value(std::vector<Value>&& value) : _type(ValueVectorType), _impl(ValueImpl::create<ValueVector>(std::move(value))) {}
+Value::Value(const std::initializer_list<Value>& value) : _type(ValueVectorType), _impl(ValueImpl::create<ValueVector>(value)) {}
 
 /**
  *  Map constructor
  *  @param  value
  */
-Value::Value(const std::map<std::string, Value>& value) : _impl(new ValueMap(value)) {}
-Value::Value(std::map<std::string, Value>&& value) : _impl(new ValueMap(std::move(value))) {}
-Value::Value(const std::initializer_list<std::map<std::string, Value>::value_type>& value) : _impl(new ValueMap(value)) {}
+Value::Value(const std::map<std::string, Value>& value) : _type(ValueMapType), _impl(ValueImpl::create<ValueMap>(value)) {}
+Value::Value(std::map<std::string, Value>&& value) : _type(ValueMapType), _impl(ValueImpl::create<ValueMap>(std::move(value))) {}
+Value::Value(const std::initializer_list<std::map<std::string, Value>::value_type>& value) : _type(ValueMapType), _impl(ValueImpl::create<ValueMap>(value)) {}
+
+/**
+ *  Implementation constructor
+ *  @param  impl
+ */
+Value::Value(ValueImpl* impl) : _type(impl->type()), _impl(impl) {}
+
+/**
+ *  Release the implementation, if we have one
+ */
+void Value::release() noexcept
+{
+    // scalar values do not own any resources
+    if (_type >= ValueStringType) _impl->release();
+
+    // we are now a null value
+    _type = ValueNullType;
+}
+
+/**
+ *  Take over the value held by another object,
+ *  leaving the other object as a null value
+ *
+ *  @param  that
+ */
+void Value::steal(Value& that) noexcept
+{
+    // copy the inline value or the implementation pointer
+    switch (that._type)
+    {
+        case ValueNullType:     break;
+        case ValueBoolType:     _bool = that._bool; break;
+        case ValueInt32Type:    _int32 = that._int32; break;
+        case ValueInt64Type:    _int64 = that._int64; break;
+        case ValueDoubleType:   _double = that._double; break;
+        default:                _impl = that._impl; break;
+    }
+
+    // take over the type, the other object no longer owns anything
+    _type = that._type;
+    that._type = ValueNullType;
+}
+
+/**
+ *  Make sure we have a private copy of the implementation,
+ *  this must be called before the implementation is modified
+ */
+void Value::detach()
+{
+    // nothing to do if nobody else uses our implementation
+    if (_type < ValueStringType || !_impl->shared()) return;
+
+    // replace the shared implementation with a copy of our own, that lives in the same place
+    ValueArena arena(_impl->arena());
+    ValueImpl *impl = _impl->clone();
+    _impl->release();
+    _impl = impl;
+}
+
+/**
+ *  Prepare the value to have one of its members modified
+ *  @param  type
+ *  @return ValueImpl
+ */
+ValueImpl *Value::container(ValueType type)
+{
+    // turn us into a container of the right type
+    if (_type != type && type == ValueVectorType) *this = std::vector<Value>();
+    if (_type != type && type == ValueMapType) *this = std::map<std::string, Value>();
+
+    // we are about to be modified
+    detach();
+
+    // expose the implementation
+    return _impl;
+}
+
+/**
+ *  Deserialize a json string into a Value
+ *  Returns a null Value in case of any errors
+ */
+Value Value::fromJson(std::string_view json)
+{
+    // parse without reporting the error
+    JsonError error;
+    return fromJson(json, error);
+}
+
+/**
+ *  Deserialize a json string into a Value, and report errors
+ */
+Value Value::fromJson(std::string_view json, JsonError& error)
+{
+    // parse straight into our output
+    Value output;
+    JsonParser parser(json);
+
+    // return the output if the json was valid
+    if (parser.parse(output))
+    {
+        error = JsonError();
+        return output;
+    }
+
+    // report the error
+    error.offset = parser.offset();
+    error.reason = parser.reason();
+    return nullptr;
+}
+
+/**
+ *  Deserialize a json string into a Value that is decoded on demand
+ */
+Value Value::fromJsonLazy(std::string json)
+{
+    // parse without reporting the error
+    JsonError error;
+    return fromJsonLazy(std::move(json), error);
+}
+
+/**
+ *  Deserialize a json string into a Value that is decoded on demand, and report errors
+ */
+Value Value::fromJsonLazy(std::string json, JsonError& error)
+{
+    // take over the json text, and record where its objects and arrays are
+    auto source = std::make_shared<JsonSource>(std::move(json));
+    JsonParser parser(source->json);
+
+    // report invalid json
+    if (!parser.index(*source))
+    {
+        error.offset = parser.offset();
+        error.reason = parser.reason();
+        return nullptr;
+    }
+
+    // the json is valid
+    error = JsonError();
+
+    // a scalar document has nothing to decode later
+    if (source->containers.empty()) return fromJson(source->json);
+
+    // the document itself is the first container
+    return Value(ValueImpl::create<ValueLazy>(source, 0));
+}
+
+/**
+ *  Deserialize MessagePack data into a Value
+ */
+Value Value::fromMsgPack(std::string_view data)
+{
+    // parse without reporting the error
+    JsonError error;
+    return fromMsgPack(data, error);
+}
+
+/**
+ *  Deserialize MessagePack data into a Value, and report errors
+ */
+Value Value::fromMsgPack(std::string_view data, JsonError& error)
+{
+    // parse straight into our output
+    Value output;
+    MsgPackParser parser(data);
+
+    // return the output if the data was valid
+    if (parser.parse(output))
+    {
+        error = JsonError();
+        return output;
+    }
+
+    // report the error
+    error.offset = parser.offset();
+    error.reason = parser.reason();
+    return nullptr;
+}
+
+/**
+ *  Deserialize CBOR data, with or without copying the strings
+ *
+ *  @param  data    the data to parse
+ *  @param  borrow  should strings refer to the data?
+ *  @param  error   filled with the error, if any
+ *  @return the parsed value, or null if the data was invalid
+ */
+static Value parseCbor(std::string_view data, bool borrow, JsonError& error)
+{
+    // parse straight into our output
+    Value output;
+    CborParser parser(data, borrow);
+
+    // return the output if the data was valid
+    if (parser.parse(output))
+    {
+        error = JsonError();
+        return output;
+    }
+
+    // report the error
+    error.offset = parser.offset();
+    error.reason = parser.reason();
+    return nullptr;
+}
+
+/**
+ *  Deserialize CBOR data into a Value
+ */
+Value Value::fromCbor(std::string_view data)
+{
+    // parse without reporting the error
+    JsonError error;
+    return parseCbor(data, false, error);
+}
+
+/**
+ *  Deserialize CBOR data into a Value, and report errors
+ */
+Value Value::fromCbor(std::string_view data, JsonError& error)
+{
+    return parseCbor(data, false, error);
+}
+
+/**
+ *  Deserialize CBOR data into a Value, without copying the strings
+ */
+Value Value::fromCborView(std::string_view data)
+{
+    // parse without reporting the error
+    JsonError error;
+    return parseCbor(data, true, error);
+}
+
+/**
+ *  Deserialize CBOR data into a Value without copying the strings, and report errors
+ */
+Value Value::fromCborView(std::string_view data, JsonError& error)
+{
+    return parseCbor(data, true, error);
+}
+
+/**
+ *  Read a Value from a snapshot
+ *
+ *  @param  snapshot    the snapshot to read
+ *  @return the root value, or null if this is not a snapshot
+ */
+static Value readSnapshot(const std::shared_ptr<const Snapshot>& snapshot)
+{
+    // check the header
+    if (!snapshot->valid()) return nullptr;
+
+    // decode the root, containers are decoded when they are accessed
+    return ValueSnapshot::decode(snapshot, *snapshot->root());
+}
+
+/**
+ *  Read a Value from a binary snapshot, without decoding it
+ */
+Value Value::fromSnapshot(std::string_view data)
+{
+    return readSnapshot(std::make_shared<Snapshot>(data.data(), data.size(), false));
+}
+
+/**
+ *  Map a snapshot file into memory and read a Value from it
+ */
+Value Value::fromSnapshotFile(const char *filename)
+{
+    // open the file and find out its size
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    // map the file, the mapping stays valid after the file is closed
+    void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return nullptr;
+
+    // the snapshot unmaps the file when it is no longer used
+    return readSnapshot(std::make_shared<Snapshot>((const char *)data, info.st_size, true));
+}
+
+/**
+ *  Parse a json string and report its contents to a handler
+ */
+bool Value::parseJson(std::string_view json, JsonHandler& handler)
+{
+    // parse without reporting the error
+    JsonError error;
+    return parseJson(json, handler, error);
+}
+
+/**
+ *  Parse a json string and report its contents to a handler
+ */
+bool Value::parseJson(std::string_view json, JsonHandler& handler, JsonError& error)
+{
+    // report the json to the handler
+    JsonParser parser(json);
+    bool success = parser.parse(handler);
 
-static Value jsonToValue(struct json_object *obj)
+    // report the error, if any
+    error.offset = success ? 0 : parser.offset();
+    error.reason = success ? nullptr : parser.reason();
+    return success;
+}
+
+/**
+ *  Convert a json-c object into a Value
+ */
+Value Value::fromJson(struct json_object *obj)
 {
     // Switch through all the json_object types and return the according Value
     switch (json_object_get_type(obj))
@@ -96,20 +463,20 @@ static Value jsonToValue(struct json_object *obj)
             std::vector<Value> output;
             output.reserve(len);
 
-            // Loop through the array and add every json_object to the vector using jsonToValue (recursive)
-            for (int i = 0; i < len; ++i) output.push_back(jsonToValue(json_object_array_get_idx(obj, i)));
+            // Loop through the array and add every json_object to the vector using fromJson (recursive)
+            for (int i = 0; i < len; ++i) output.push_back(fromJson(json_object_array_get_idx(obj, i)));
 
             // Return our output
             return output;
         }
         case json_type_object: {
-            // Declare our output
-            std::map<std::string, Value> output;
+            // Declare our output, members are added straight into it
+            Value output = std::map<std::string, Value>();
 
-            // Loop through the object and add all json_objects to our map using jsonToValue (recursive)
+            // Loop through the object and add all json_objects to our map using fromJson (recursive)
             json_object_object_foreach(obj, key, val)
             {
-                output[key] = jsonToValue(val);
+                output[key] = fromJson(val);
             }
 
             // Return our output
@@ -118,31 +485,12 @@ static Value jsonToValue(struct json_object *obj)
     }
 }
 
-/**
- *  Deserialize a json string into a Value
- *  Returns a null Value in case of any errors
- */
-Value Value::fromJson(const std::string& json)
-{
-    // Create our output and parse the json using json_tokener_parse(const char*)
-    struct json_object *parsed = json_tokener_parse(json.data());
-
-    // Turn the output into a Value object
-    Value output = jsonToValue(parsed);
-
-    // Decrement the reference count
-    json_object_put(parsed);
-
-    // Return the output
-    return output;
-}
-
 /**
  *  Get the type of value we are
  */
 ValueType Value::type() const
 {
-    return _impl->type();
+    return _type;
 }
 
 /**
@@ -151,8 +499,8 @@ ValueType Value::type() const
  */
 Value& Value::operator=(const Value& value)
 {
-    // assign implementation and allow chaining
-    _impl = ValueImplPtr(value._impl->clone());
+    // copy the value and allow chaining
+    if (this != &value) *this = Value(value);
     return *this;
 }
 
@@ -160,10 +508,14 @@ Value& Value::operator=(const Value& value)
  *  Assign another value
  *  @param  value
  */
-Value& Value::operator=(Value&& value)
+Value& Value::operator=(Value&& value) noexcept
 {
-    // move the implementation
-    _impl = std::move(value._impl);
+    // self-assignment is a no-op
+    if (this == &value) return *this;
+
+    // release what we have and take over the other value
+    release();
+    steal(value);
     return *this;
 }
 
@@ -172,7 +524,15 @@ Value& Value::operator=(Value&& value)
  */
 Value::operator bool () const
 {
-    return *_impl;
+    switch (_type)
+    {
+        case ValueNullType:     return false;
+        case ValueBoolType:     return _bool;
+        case ValueInt32Type:    return _int32;
+        case ValueInt64Type:    return _int64;
+        case ValueDoubleType:   return _double;
+        default:                return *_impl;
+    }
 }
 
 /**
@@ -180,7 +540,9 @@ Value::operator bool () const
  */
 Value& Value::operator=(bool value)
 {
-    _impl = ValueImplPtr(new ValueBool(value));
+    release();
+    _type = ValueBoolType;
+    _bool = value;
     return *this;
 }
 
@@ -189,7 +551,15 @@ Value& Value::operator=(bool value)
  */
 Value::operator int32_t () const
 {
-    return *_impl;
+    switch (_type)
+    {
+        case ValueNullType:     return 0;
+        case ValueBoolType:     return _bool;
+        case ValueInt32Type:    return _int32;
+        case ValueInt64Type:    return _int64;
+        case ValueDoubleType:   return _double;
+        default:                return *_impl;
+    }
 }
 
 /**
@@ -197,7 +567,15 @@ Value::operator int32_t () const
  */
 Value::operator int64_t () const
 {
-    return *_impl;
+    switch (_type)
+    {
+        case ValueNullType:     return 0;
+        case ValueBoolType:     return _bool;
+        case ValueInt32Type:    return _int32;
+        case ValueInt64Type:    return _int64;
+        case ValueDoubleType:   return _double;
+        default:                return *_impl;
+    }
 }
 
 /**
@@ -205,7 +583,102 @@ Value::operator int64_t () const
  */
 Value::operator double () const
 {
-    return *_impl;
+    switch (_type)
+    {
+        case ValueNullType:     return 0;
+        case ValueBoolType:     return _bool;
+        case ValueInt32Type:    return _int32;
+        case ValueInt64Type:    return _int64;
+        case ValueDoubleType:   return _double;
+        default:                return *_impl;
+    }
+}
+
+/**
+ *  Store an integer in a type, if it fits
+ *
+ *  @param  value
+ *  @param  result
+ *  @return did it fit?
+ */
+template <typename T>
+static bool convert(int64_t value, T& result)
+{
+    // the value must be within the range of the type
+    if (value < std::numeric_limits<T>::min() || value > std::numeric_limits<T>::max()) return false;
+
+    // store it
+    result = (T)value;
+    return true;
+}
+
+/**
+ *  Store a floating point number in an integer, if it fits exactly
+ *
+ *  @param  value
+ *  @param  result
+ *  @return did it fit?
+ */
+template <typename T>
+static bool convert(double value, T& result)
+{
+    // the limits of the type, as a power of two that is exact as a double
+    const double limit = std::ldexp(1.0, std::numeric_limits<T>::digits);
+
+    // the value must be an integer within the range (this also rejects not-a-number)
+    if (!(value >= -limit && value < limit) || value != std::trunc(value)) return false;
+
+    // store it
+    result = (T)value;
+    return true;
+}
+
+/**
+ *  Convert to a number, but only if the value really holds one
+ */
+bool Value::tryCast(int32_t& result) const
+{
+    switch (_type)
+    {
+        case ValueNullType:     return false;
+        case ValueBoolType:     return convert((int64_t)_bool, result);
+        case ValueInt32Type:    return convert((int64_t)_int32, result);
+        case ValueInt64Type:    return convert(_int64, result);
+        case ValueDoubleType:   return convert(_double, result);
+        default:                return _impl->tryCast(result);
+    }
+}
+
+/**
+ *  Convert to a number, but only if the value really holds one
+ */
+bool Value::tryCast(int64_t& result) const
+{
+    switch (_type)
+    {
+        case ValueNullType:     return false;
+        case ValueBoolType:     return convert((int64_t)_bool, result);
+        case ValueInt32Type:    return convert((int64_t)_int32, result);
+        case ValueInt64Type:    return convert(_int64, result);
+        case ValueDoubleType:   return convert(_double, result);
+        default:                return _impl->tryCast(result);
+    }
+}
+
+/**
+ *  Convert to a number, but only if the value really holds one
+ */
+bool Value::tryCast(double& result) const
+{
+    switch (_type)
+    {
+        case ValueNullType:     return false;
+        case ValueBoolType:     result = _bool; return true;
+        case ValueInt32Type:    result = _int32; return true;
+        case ValueInt64Type:    result = _int64; return true;
+        case ValueDoubleType:   result = _double; return true;
+        default:                return _impl->tryCast(result);
+    }
 }
 
 /**
@@ -213,7 +686,9 @@ Value::operator double () const
  */
 Value& Value::operator=(int32_t value)
 {
-    _impl = ValueImplPtr(new ValueInt32(value));
+    release();
+    _type = ValueInt32Type;
+    _int32 = value;
     return *this;
 }
 
@@ -222,7 +697,9 @@ Value& Value::operator=(int32_t value)
  */
 Value& Value::operator=(int64_t value)
 {
-    _impl = ValueImplPtr(new ValueInt64(value));
+    release();
+    _type = ValueInt64Type;
+    _int64 = value;
     return *this;
 }
 
@@ -231,7 +708,9 @@ Value& Value::operator=(int64_t value)
  */
 Value& Value::operator=(double value)
 {
-    _impl = ValueImplPtr(new ValueDouble(value));
+    release();
+    _type = ValueDoubleType;
+    _double = value;
     return *this;
 }
 
@@ -240,7 +719,15 @@ Value& Value::operator=(double value)
  */
 Value::operator std::string () const
 {
-    return *_impl;
+    switch (_type)
+    {
+        case ValueNullType:     return "";
+        case ValueBoolType:     return std::to_string(_bool);
+        case ValueInt32Type:    return std::to_string(_int32);
+        case ValueInt64Type:    return std::to_string(_int64);
+        case ValueDoubleType:   return std::to_string(_double);
+        default:                return *_impl;
+    }
 }
 
 /**
@@ -248,7 +735,7 @@ Value::operator std::string () const
  */
 Value& Value::operator=(const char* value)
 {
-    _impl = ValueImplPtr(new ValueString(value));
+    *this = Value(value);
     return *this;
 }
 
@@ -257,7 +744,7 @@ Value& Value::operator=(const char* value)
  */
 Value& Value::operator=(const std::string& value)
 {
-    _impl = ValueImplPtr(new ValueString(value));
+    *this = Value(value);
     return *this;
 }
 
@@ -266,10 +753,31 @@ Value& Value::operator=(const std::string& value)
  */
 Value& Value::operator=(std::string&& value)
 {
-    _impl = ValueImplPtr(new ValueString(std::move(value)));
+    *this = Value(std::move(value));
+    return *this;
+}
+
+/**
+ *  Assign a string
+ */
+Value& Value::operator=(std::string_view value)
+{
+    *this = Value(value);
     return *this;
 }
 
+/**
+ *  The bytes of a string, without copying them
+ */
+std::string_view Value::view() const
+{
+    // scalar values have no bytes
+    if (_type < ValueStringType) return std::string_view();
+
+    // ask the implementation
+    return _impl->view();
+}
+
 /**
  *  Get the number of elements in the variant
  *
@@ -278,6 +786,10 @@ Value& Value::operator=(std::string&& value)
  */
 size_t Value::size() const
 {
+    // scalar values have no elements
+    if (_type < ValueStringType) return 0;
+
+    // ask the implementation
     return _impl->size();
 }
 
@@ -286,7 +798,15 @@ size_t Value::size() const
  */
 struct json_object *Value::toJson() const
 {
-    return _impl->toJson();
+    switch (_type)
+    {
+        case ValueNullType:     return nullptr;
+        case ValueBoolType:     return json_object_new_boolean(_bool);
+        case ValueInt32Type:    return json_object_new_int(_int32);
+        case ValueInt64Type:    return json_object_new_int64(_int64);
+        case ValueDoubleType:   return json_object_new_double(_double);
+        default:                return _impl->toJson();
+    }
 }
 
 /**
@@ -294,16 +814,93 @@ struct json_object *Value::toJson() const
  */
 std::string Value::toJsonString() const
 {
-    // Turn our value implementation into a json_object
-    struct json_object *json = toJson();
+    // write the value into a new string
+    std::string output;
+    toJsonString(output);
+    return output;
+}
+
+/**
+ *  Append the value to a json string
+ *  @param  output
+ */
+void Value::toJsonString(std::string& output) const
+{
+    switch (_type)
+    {
+        case ValueNullType:     output.append("null", 4); break;
+        case ValueBoolType:     _bool ? output.append("true", 4) : output.append("false", 5); break;
+        case ValueInt32Type:    JsonWriter::number(output, (int64_t)_int32); break;
+        case ValueInt64Type:    JsonWriter::number(output, _int64); break;
+        case ValueDoubleType:   JsonWriter::number(output, _double); break;
+        default:                _impl->toJson(output); break;
+    }
+}
+
+/**
+ *  Serialize the value to MessagePack
+ */
+std::string Value::toMsgPack() const
+{
+    // write the value into a new string
+    std::string output;
+    toMsgPack(output);
+    return output;
+}
+
+/**
+ *  Append the value to a MessagePack buffer
+ *  @param  output
+ */
+void Value::toMsgPack(std::string& output) const
+{
+    switch (_type)
+    {
+        case ValueNullType:     MsgPackWriter::null(output); break;
+        case ValueBoolType:     MsgPackWriter::boolean(output, _bool); break;
+        case ValueInt32Type:    MsgPackWriter::number(output, _int32); break;
+        case ValueInt64Type:    MsgPackWriter::number(output, _int64); break;
+        case ValueDoubleType:   MsgPackWriter::number(output, _double); break;
+        default:                _impl->toMsgPack(output); break;
+    }
+}
 
-    // Turn this json_object into a string
-    std::string output(json_object_to_json_string(json));
+/**
+ *  Serialize the value to CBOR
+ */
+std::string Value::toCbor() const
+{
+    // write the value into a new string
+    std::string output;
+    toCbor(output);
+    return output;
+}
 
-    // Decrement the reference count
-    json_object_put(json);
+/**
+ *  Append the value to a CBOR buffer
+ *  @param  output
+ */
+void Value::toCbor(std::string& output) const
+{
+    switch (_type)
+    {
+        case ValueNullType:     CborWriter::null(output); break;
+        case ValueBoolType:     CborWriter::boolean(output, _bool); break;
+        case ValueInt32Type:    CborWriter::number(output, _int32); break;
+        case ValueInt64Type:    CborWriter::number(output, _int64); break;
+        case ValueDoubleType:   CborWriter::number(output, _double); break;
+        default:                _impl->toCbor(output); break;
+    }
+}
 
-    // Return this string
+/**
+ *  Serialize the value to a binary snapshot
+ */
+std::string Value::toSnapshot() const
+{
+    // write the value into a new string, it is of no use if something did not fit
+    std::string output;
+    if (!SnapshotWriter(output).write(*this)) output.clear();
     return output;
 }
 
@@ -312,6 +909,10 @@ std::string Value::toJsonString() const
  */
 Value::operator std::vector<Value> () const
 {
+    // scalar values have no elements
+    if (_type < ValueStringType) return {};
+
+    // ask the implementation
     return *_impl;
 }
 
@@ -320,7 +921,7 @@ Value::operator std::vector<Value> () const
  */
 Value& Value::operator=(const std::initializer_list<Value>& value)
 {
-    _impl = ValueImplPtr(new ValueVector(value));
+    *this = Value(value);
     return *this;
 }
 
@@ -329,7 +930,7 @@ Value& Value::operator=(const std::initializer_list<Value>& value)
  */
 Value& Value::operator=(const std::vector<Value>& value)
 {
-    _impl = ValueImplPtr(new ValueVector(value));
+    *this = Value(value);
     return *this;
 }
 
@@ -338,7 +939,7 @@ Value& Value::operator=(const std::vector<Value>& value)
  */
 Value& Value::operator=(std::vector<Value>&& value)
 {
-    _impl = ValueImplPtr(new ValueVector(std::move(value)));
+    *this = Value(std::move(value));
     return *this;
 }
 
@@ -346,9 +947,13 @@ Value& Value::operator=(std::vector<Value>&& value)
  *  Array access operator
  *  @param  index
  */
-Value Value::operator [] (int index) const
+const Value& Value::operator [] (int index) const
 {
-    return _impl->get(index);
+    // look up the element
+    auto *result = find(index);
+
+    // expose the element, or null if it does not exist
+    return result ? *result : null;
 }
 
 /**
@@ -358,10 +963,10 @@ Value Value::operator [] (int index) const
 ValueMember<int> Value::operator [] (int index)
 {
     // we must be of the vector type
-    if (_impl->type() != ValueVectorType) _impl = ValueImplPtr(new ValueVector());
+    if (_type != ValueVectorType) *this = std::vector<Value>();
 
-    // retrieve the offset
-    return ValueMember<int>(_impl.get(), index);
+    // the member makes a private copy when it is assigned to
+    return ValueMember<int>(this, index);
 }
 
 /**
@@ -369,6 +974,10 @@ ValueMember<int> Value::operator [] (int index)
  */
 Value::operator std::map<std::string, Value> () const
 {
+    // scalar values have no members
+    if (_type < ValueStringType) return {};
+
+    // ask the implementation
     return *_impl;
 }
 
@@ -377,7 +986,7 @@ Value::operator std::map<std::string, Value> () const
  */
 Value& Value::operator=(const std::initializer_list<std::map<std::string, Value>::value_type>& value)
 {
-    _impl = ValueImplPtr(new ValueMap(value));
+    *this = Value(value);
     return *this;
 }
 
@@ -386,7 +995,7 @@ Value& Value::operator=(const std::initializer_list<std::map<std::string, Value>
  */
 Value& Value::operator=(const std::map<std::string, Value>& value)
 {
-    _impl = ValueImplPtr(new ValueMap(value));
+    *this = Value(value);
     return *this;
 }
 
@@ -395,7 +1004,7 @@ Value& Value::operator=(const std::map<std::string, Value>& value)
  */
 Value& Value::operator=(std::map<std::string, Value>&& value)
 {
-    _impl = ValueImplPtr(new ValueMap(std::move(value)));
+    *this = Value(std::move(value));
     return *this;
 }
 
@@ -403,18 +1012,31 @@ Value& Value::operator=(std::map<std::string, Value>&& value)
  *  Array access operator
  *  @param  key
  */
-const Value Value::operator [] (const char* key) const
+const Value& Value::operator [] (const char* key) const
+{
+    return (*this)[std::string_view(key)];
+}
+
+/**
+ *  Array access operator
+ *  @param  key
+ */
+const Value& Value::operator [] (const std::string& key) const
 {
-    return _impl->get(std::string{key});
+    return (*this)[std::string_view(key)];
 }
 
 /**
  *  Array access operator
  *  @param  key
  */
-const Value Value::operator [] (const std::string& key) const
+const Value& Value::operator [] (std::string_view key) const
 {
-    return _impl->get(key);
+    // look up the member
+    auto *result = find(key);
+
+    // expose the member, or null if it does not exist
+    return result ? *result : null;
 }
 
 /**
@@ -422,32 +1044,242 @@ const Value Value::operator [] (const std::string& key) const
  *  @param  key
  */
 ValueMember<std::string> Value::operator [] (const char* key)
+{
+    return (*this)[std::string{key}];
+}
+
+/**
+ *  Overwritable array access operator
+ *  @param  key
+ */
+ValueMember<std::string> Value::operator [] (const std::string& key)
 {
     // we must be of the map type
-    if (_impl->type() != ValueMapType) _impl = ValueImplPtr(new ValueMap());
+    if (_type != ValueMapType) *this = std::map<std::string, Value>();
 
-    // retrieve the offset
-    return ValueMember<std::string>(_impl.get(), std::string{key});
+    // the member makes a private copy when it is assigned to
+    return ValueMember<std::string>(this, key);
 }
 
 /**
  *  Overwritable array access operator
  *  @param  key
  */
-ValueMember<std::string> Value::operator [] (const std::string& key)
+ValueMember<std::string_view> Value::operator [] (std::string_view key)
 {
     // we must be of the map type
-    if (_impl->type() != ValueMapType) _impl = ValueImplPtr(new ValueMap());
+    if (_type != ValueMapType) *this = std::map<std::string, Value>();
+
+    // the member makes a private copy when it is assigned to
+    return ValueMember<std::string_view>(this, key);
+}
+
+/**
+ *  Look up an element without copying it
+ *  @param  index
+ */
+const Value* Value::find(int index) const
+{
+    // scalar values have no elements
+    if (_type < ValueStringType) return nullptr;
+
+    // ask the implementation
+    return _impl->find(index);
+}
+
+/**
+ *  Look up a member without copying it
+ *  @param  key
+ */
+const Value* Value::find(const char* key) const
+{
+    return find(std::string_view(key));
+}
 
-    // retrieve the offset
-    return ValueMember<std::string>(_impl.get(), key);
+/**
+ *  Look up a member without copying it
+ *  @param  key
+ */
+const Value* Value::find(const std::string& key) const
+{
+    return find(std::string_view(key));
+}
+
+/**
+ *  Look up a member without copying it
+ *  @param  key
+ */
+const Value* Value::find(std::string_view key) const
+{
+    // scalar values have no members
+    if (_type < ValueStringType) return nullptr;
+
+    // ask the implementation
+    return _impl->find(key);
+}
+
+/**
+ *  Iterator to the first element
+ */
+ValueIterator Value::begin() const
+{
+    // scalar values have no elements
+    if (_type < ValueStringType) return ValueIterator();
+
+    // start at the first element
+    return ValueIterator(_impl, 0);
+}
+
+/**
+ *  Iterator past the last element
+ */
+ValueIterator Value::end() const
+{
+    // scalar values have no elements
+    if (_type < ValueStringType) return ValueIterator();
+
+    // stop after the last element
+    return ValueIterator(_impl, _impl->size());
 }
 
+/**
+ *  Equals operator
+ *  @param  that
+ */
 bool Value::operator==(const Value &that) const
 {
-    if (type() == that.type()) return *_impl == *that._impl;
+    // values of a different type are never equal
+    if (_type != that._type) return false;
+
+    // values that share their implementation are always equal
+    if (_type >= ValueStringType && _impl == that._impl) return true;
+
+    // compare the inline values, or let the implementation decide
+    switch (_type)
+    {
+        case ValueNullType:     return true;
+        case ValueBoolType:     return _bool == that._bool;
+        case ValueInt32Type:    return _int32 == that._int32;
+        case ValueInt64Type:    return _int64 == that._int64;
+        case ValueDoubleType:   return _double == that._double || (std::isnan(_double) && std::isnan(that._double));
+        default:                return *_impl == *that._impl;
+    }
+}
+
+/**
+ *  Compare two numbers of a different type
+ *
+ *  @param  a
+ *  @param  b
+ *  @return negative when smaller, zero when the same, positive when bigger
+ */
+template <typename A, typename B>
+static int compareNumbers(A a, B b)
+{
+    return a < b ? -1 : b < a;
+}
+
+/**
+ *  Compare an integer with a floating point number, without losing precision
+ *
+ *  @param  a
+ *  @param  b
+ *  @return negative when smaller, zero when the same, positive when bigger
+ */
+static int compareNumbers(int64_t a, double b)
+{
+    // not-a-number goes after all other numbers
+    if (std::isnan(b)) return -1;
+
+    // numbers outside the integer range are always bigger or smaller
+    if (b >= 9223372036854775808.0) return -1;
+    if (b < -9223372036854775808.0) return 1;
+
+    // compare the integral part, which fits in an integer now
+    int64_t integral = (int64_t)b;
+    if (a != integral) return a < integral ? -1 : 1;
+
+    // and the fraction, which is exact
+    double fraction = b - (double)integral;
+    return fraction > 0.0 ? -1 : fraction < 0.0;
+}
+
+/**
+ *  Compare two floating point numbers, not-a-number goes last
+ *
+ *  @param  a
+ *  @param  b
+ *  @return negative when smaller, zero when the same, positive when bigger
+ */
+static int compareNumbers(double a, double b)
+{
+    if (a < b) return -1;
+    if (b < a) return 1;
+    return std::isnan(a) - std::isnan(b);
+}
+
+/**
+ *  Compare with another value
+ *
+ *  @param  that
+ *  @return negative when smaller, zero when equivalent, positive when bigger
+ */
+int Value::compare(const Value &that) const
+{
+    // values of the same type are compared directly
+    if (_type == that._type) switch (_type)
+    {
+        case ValueNullType:     return 0;
+        case ValueBoolType:     return compareNumbers(_bool, that._bool);
+        case ValueInt32Type:    return compareNumbers(_int32, that._int32);
+        case ValueInt64Type:    return compareNumbers(_int64, that._int64);
+        case ValueDoubleType:   return compareNumbers(_double, that._double);
+        default:                return _impl->compare(*that._impl);
+    }
+
+    // numbers of a different type are compared by their value first
+    if (_type >= ValueInt32Type && _type <= ValueDoubleType && that._type >= ValueInt32Type && that._type <= ValueDoubleType)
+    {
+        // the value of an integer, of either size
+        auto integer = [](const Value &value) -> int64_t { return value._type == ValueInt32Type ? value._int32 : value._int64; };
+
+        // compare them, a floating point number is never converted to an integer
+        int result = _type == ValueDoubleType ? -compareNumbers(integer(that), _double) : that._type == ValueDoubleType ? compareNumbers(integer(*this), that._double) : compareNumbers(integer(*this), integer(that));
+        if (result != 0) return result;
+    }
+
+    // otherwise the type decides
+    return _type < that._type ? -1 : 1;
+}
+
+/**
+ *  Calculate the structural hash
+ *
+ *  @param  seed
+ *  @return uint64_t
+ */
+uint64_t Value::hash(uint64_t seed) const
+{
+    // the type is part of the hash, because values of a different type are never equal
+    uint64_t result = Hash::mix(seed, _type);
 
-    return false;
+    // hash the inline values, or let the implementation do it
+    switch (_type)
+    {
+        case ValueNullType:     return result;
+        case ValueBoolType:     return Hash::mix(result, _bool);
+        case ValueInt32Type:    return Hash::mix(result, (uint64_t)_int32);
+        case ValueInt64Type:    return Hash::mix(result, (uint64_t)_int64);
+        case ValueDoubleType:
+        {
+            // zero and negative zero are equal, and so is every not-a-number, so they must hash the same
+            double value = _double == 0.0 ? 0.0 : std::isnan(_double) ? std::numeric_limits<double>::quiet_NaN() : _double;
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return Hash::mix(result, bits);
+        }
+        default:                return _impl->hash(seed);
+    }
 }
 
 /**
@@ -8,12 +8,29 @@
 
 #include "../include/ValueImpl.h"
 #include "../include/Value.h"
+#include "ValuePool.h"
 
 /**
  *  Set up namespace
  */
 namespace Variant {
 
+/**
+ *  Allocate an implementation from the pool of this thread
+ */
+void *ValueImpl::operator new(size_t size)
+{
+    return ValuePool::allocate(size);
+}
+
+/**
+ *  Give the memory of an implementation back to its pool
+ */
+void ValueImpl::operator delete(void *pointer, size_t size)
+{
+    ValuePool::deallocate(pointer, size);
+}
+
 /**
  *  Convert the value to a boolean
  */
@@ -46,6 +63,33 @@ ValueImpl::operator double () const
     return 0;
 }
 
+/**
+ *  Convert the value to a number, if it holds nothing but a number
+ *
+ *  This is only relevant for string values,
+ *  so it fails by default.
+ */
+bool ValueImpl::tryCast(int32_t& result) const
+{
+    return false;
+}
+
+/**
+ *  Convert the value to a number, if it holds nothing but a number
+ */
+bool ValueImpl::tryCast(int64_t& result) const
+{
+    return false;
+}
+
+/**
+ *  Convert the value to a number, if it holds nothing but a number
+ */
+bool ValueImpl::tryCast(double& result) const
+{
+    return false;
+}
+
 /**
  *  Convert the value to a string
  */
@@ -54,6 +98,14 @@ ValueImpl::operator std::string () const
     return "";
 }
 
+/**
+ *  The bytes of a string value, without copying them
+ */
+std::string_view ValueImpl::view() const
+{
+    return std::string_view();
+}
+
 /**
  *  Convert the value to a vector
  *
@@ -89,69 +141,134 @@ size_t ValueImpl::size() const
 }
 
 /**
- *  Retrieve value at the given offset
+ *  Look up the value at the given offset
  *
  *  This is only applicable for array values,
- *  so it returns a null value by default.
+ *  so it returns a nullptr by default.
  */
-Value ValueImpl::get(size_t index) const
+const Value* ValueImpl::find(size_t index) const
 {
     return nullptr;
 }
 
 /**
- *  Set value at the given offset
+ *  Retrieve a modifiable value at the given offset,
+ *  the value is created if it does not yet exist
  *
  *  This is only applicable for array values,
- *  other implementation will ignore this.
+ *  for other implementations changes are ignored.
  */
-ValueImpl& ValueImpl::set(size_t index, const Value& value)
+Value& ValueImpl::member(size_t index)
 {
-    return *this;
+    // hand out a scratch value, anything written to it is lost
+    static thread_local Value ignored;
+    return ignored = Value();
 }
 
 /**
- *  Set value at the given offset
+ *  Look up the value at the given key
  *
- *  This is only applicable for array values,
- *  other implementation will ignore this.
+ *  This is only applicable for map values,
+ *  so it returns a nullptr by default.
  */
-ValueImpl& ValueImpl::set(size_t index, Value&& value)
+const Value* ValueImpl::find(std::string_view key) const
 {
-    return *this;
+    return nullptr;
 }
 
 /**
- *  Retrieve value at the given key
+ *  Retrieve a modifiable value at the given key,
+ *  the value is created if it does not yet exist
  *
- *  This is only applicable for map values
- *  so it returns a null value by default.
+ *  This is only applicable for map values,
+ *  for other implementations changes are ignored.
  */
-Value ValueImpl::get(const std::string& key) const
+Value& ValueImpl::member(std::string_view key)
 {
-    return nullptr;
+    // hand out a scratch value, anything written to it is lost
+    static thread_local Value ignored;
+    return ignored = Value();
 }
 
 /**
- *  Set value at the given key
+ *  Look up the element at the given position, to iterate over it
  *
- *  This is only applicable for map value,
- *  other implementation will ignore this.
+ *  @param  index   position of the element
+ *  @param  key     the key of the element
+ *  @return the value of the element
  */
-ValueImpl& ValueImpl::set(const std::string& key, const Value& value)
+const Value* ValueImpl::at(size_t index, std::string_view& key) const
 {
-    return *this;
+    return nullptr;
 }
 
 /**
- *  Set value at the given key
+ *  Compare with an implementation of the same type
  *
- *  This is only applicable for map values,
- *  other implementation will ignore this.
+ *  @param  that
+ *  @return negative when smaller, zero when equivalent, positive when bigger
  */
-ValueImpl& ValueImpl::set(const std::string& key, Value&& value)
+int ValueImpl::compare(const ValueImpl &that) const
 {
-    return *this;
+    // an implementation is always equal to itself
+    if (&that == this) return 0;
+
+    // the sizes are needed for vectors and maps
+    size_t mine = size(), theirs = that.size();
+
+    switch (type())
+    {
+        case ValueStringType:
+        {
+            // compare the bytes, without copying them
+            int result = view().compare(that.view());
+            return result < 0 ? -1 : result > 0;
+        }
+        case ValueVectorType:
+        {
+            // compare the items in order, until one is different
+            for (size_t i = 0; i < mine && i < theirs; ++i)
+            {
+                int result = find(i)->compare(*that.find(i));
+                if (result != 0) return result;
+            }
+
+            // when all items are the same, the shorter vector goes first
+            return mine < theirs ? -1 : mine > theirs;
+        }
+        case ValueMapType:
+        {
+            // smaller maps go first
+            if (mine != theirs) return mine < theirs ? -1 : 1;
+
+            // the members are compared in key order, so the smallest key that is missing on one
+            // side, or that has a different value, decides, and that can be found without sorting
+            std::string_view first, key;
+            int result = 0;
+
+            // check our members, keys after the smallest difference so far no longer matter
+            for (size_t i = 0; const Value *value = at(i, key); ++i)
+            {
+                // when they miss the key, their member at its position has a bigger key, so we go first
+                if (result != 0 && key >= first) continue;
+                const Value *other = that.find(key);
+                int compared = other ? value->compare(*other) : -1;
+                if (compared != 0) { first = key; result = compared; }
+            }
+
+            // and the members that only they have
+            for (size_t i = 0; that.at(i, key); ++i)
+            {
+                if (result != 0 && key >= first) continue;
+                if (find(key) == nullptr) { first = key; result = 1; }
+            }
+
+            // the outcome of the smallest difference
+            return result;
+        }
+        default:
+            return 0;
+    }
 }
 
 /**
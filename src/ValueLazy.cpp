@@ -0,0 +1,39 @@
+/**
+ *  ValueLazy.cpp
+ *
+ *  Decoding of lazily parsed json containers
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "ValueLazy.h"
+#include "JsonParser.h"
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Decode the container, if that did not happen yet
+ *
+ *  @return the decoded map or vector
+ */
+ValueImpl *ValueLazy::decoded() const
+{
+    // decode a single level, the document was already checked so this can not fail,
+    // the container is allocated in the same place as we are
+    std::call_once(_once, [this]() {
+        ValueArena arena(this->arena());
+        JsonParser parser(_source->json);
+        _decoded = parser.parseLevel(_source, _node);
+    });
+
+    // expose the decoded container
+    return _decoded;
+}
+
+/**
+ *  End namespace
+ */
+}
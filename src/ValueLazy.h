@@ -0,0 +1,265 @@
+/**
+ *  ValueLazy.h
+ *
+ *  Object or array that is still stored as json text. The
+ *  members are only decoded when they are first accessed,
+ *  and then only one level deep: nested containers become
+ *  lazy values themselves. As long as nothing is modified,
+ *  the original json text is used for serializing.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include "../include/ValueImpl.h"
+#include "../include/Value.h"
+#include "JsonSource.h"
+#include "SnapshotWriter.h"
+#include <memory>
+#include <mutex>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Set up class
+ */
+class ValueLazy : public ValueImpl
+{
+private:
+    /**
+     *  The document we are part of
+     */
+    std::shared_ptr<const JsonSource> _source;
+
+    /**
+     *  Our index in the containers of the document
+     */
+    size_t _node;
+
+    /**
+     *  The decoded map or vector, decoding happens only once,
+     *  even when the value is shared between threads
+     */
+    mutable std::once_flag _once;
+    mutable ValueImpl *_decoded = nullptr;
+
+    /**
+     *  Has the decoded value been handed out for modification?
+     */
+    bool _modified = false;
+
+    /**
+     *  Decode the container, if that did not happen yet
+     *
+     *  @return the decoded map or vector
+     */
+    ValueImpl *decoded() const;
+
+    /**
+     *  Our part of the json document
+     *
+     *  @return the json text
+     */
+    std::string_view json() const
+    {
+        const auto &container = _source->containers[_node];
+        return std::string_view(_source->json).substr(container.begin, container.end - container.begin);
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  @param  source  the document, which must be valid json
+     *  @param  node    index of the container in the document
+     */
+    ValueLazy(const std::shared_ptr<const JsonSource>& source, size_t node) : _source(source), _node(node) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~ValueLazy()
+    {
+        if (_decoded) _decoded->release();
+    }
+
+    /**
+     *  Get the implementation type
+     *
+     *  This is known without decoding anything
+     */
+    virtual ValueType type() const override
+    {
+        return _source->json[_source->containers[_node].begin] == '{' ? ValueMapType : ValueVectorType;
+    }
+
+    /**
+     *  Clone the implementation
+     *
+     *  A clone is only made right before it is modified,
+     *  so we hand out a copy of the decoded container
+     */
+    virtual ValueImpl* clone() const override
+    {
+        return decoded()->clone();
+    }
+
+    /**
+     *  Convert the value to a vector
+     */
+    virtual operator std::vector<Value> () const override
+    {
+        return *decoded();
+    }
+
+    /**
+     *  Convert the value to a map
+     */
+    virtual operator std::map<std::string, Value> () const override
+    {
+        return *decoded();
+    }
+
+    /**
+     *  Get the number of items
+     */
+    virtual size_t size() const override
+    {
+        return decoded()->size();
+    }
+
+    /**
+     *  Look up the value at the given offset
+     */
+    virtual const Value* find(size_t index) const override
+    {
+        return decoded()->find(index);
+    }
+
+    /**
+     *  Retrieve a modifiable value at the given offset
+     */
+    virtual Value& member(size_t index) override
+    {
+        // from now on the json text is out of date
+        _modified = true;
+        return decoded()->member(index);
+    }
+
+    /**
+     *  Look up the value at the given key
+     */
+    virtual const Value* find(std::string_view key) const override
+    {
+        return decoded()->find(key);
+    }
+
+    /**
+     *  Retrieve a modifiable value at the given key
+     */
+    virtual Value& member(std::string_view key) override
+    {
+        // from now on the json text is out of date
+        _modified = true;
+        return decoded()->member(key);
+    }
+
+    /**
+     *  Look up the element at the given position, to iterate over it
+     */
+    virtual const Value* at(size_t index, std::string_view& key) const override
+    {
+        return decoded()->at(index, key);
+    }
+
+    /**
+     *  Turn the value into a json compatible type
+     */
+    virtual struct json_object *toJson() const override
+    {
+        return decoded()->toJson();
+    }
+
+    /**
+     *  Append the value to a json string
+     *
+     *  Unmodified values copy the original json text,
+     *  including any whitespace that it contains.
+     *
+     *  @param  output
+     */
+    virtual void toJson(std::string& output) const override
+    {
+        // forward the original text if we can
+        if (!_modified) return (void)output.append(json());
+
+        // serialize the decoded value
+        decoded()->toJson(output);
+    }
+
+    /**
+     *  Append the value to a MessagePack buffer
+     *
+     *  @param  output
+     */
+    virtual void toMsgPack(std::string& output) const override
+    {
+        decoded()->toMsgPack(output);
+    }
+
+    /**
+     *  Append the value to a CBOR buffer
+     *
+     *  @param  output
+     */
+    virtual void toCbor(std::string& output) const override
+    {
+        decoded()->toCbor(output);
+    }
+
+    /**
+     *  Write the value to a snapshot
+     *
+     *  @param  writer
+     *  @return the slot describing the value
+     */
+    virtual SnapshotSlot toSnapshot(SnapshotWriter& writer) const override
+    {
+        return decoded()->toSnapshot(writer);
+    }
+
+    /**
+     *  Calculate the structural hash
+     *
+     *  @param  seed
+     *  @return uint64_t
+     */
+    virtual uint64_t hash(uint64_t seed) const override
+    {
+        return decoded()->hash(seed);
+    }
+
+    /**
+     *  Comparison operator
+     */
+    virtual bool operator==(const ValueImpl &that) const override
+    {
+        // a value is always equal to itself
+        if (&that == this) return true;
+
+        // compare the decoded container
+        return *decoded() == that;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -4,6 +4,14 @@
  *  Value value holding a map of
  *  keys and values.
  *
+ *  The members are stored in a flat vector, in the order in which
+ *  they were added, so iterating over the map (and turning it into
+ *  json) visits the members in insertion order. Small maps are
+ *  searched linearly, larger maps get an open-addressing hash index.
+ *
+ *  Short keys are stored inline in the members, longer keys are
+ *  shared with other maps when the key table is enabled.
+ *
  *  @copyright 2014 Copernica BV
  */
 
@@ -14,6 +22,19 @@
 
 #include "../include/ValueImpl.h"
 #include "../include/Value.h"
+#include "../include/KeyTable.h"
+#include "JsonWriter.h"
+#include "MsgPackWriter.h"
+#include "CborWriter.h"
+#include "Hash.h"
+#include "SnapshotWriter.h"
+#include "SmallString.h"
+#include <functional>
+#include <type_traits>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
 #include <map>
 
 /**
@@ -28,39 +49,183 @@ class ValueMap : public ValueImpl
 {
 private:
     /**
-     *  The available items
+     *  Type of the keys, and of a single member
      */
-    std::map<std::string, Value> _items;
-public:
+    using Key = SmallString<16>;
+    using Item = std::pair<Key, Value>;
+
     /**
-     *  Empty constructor
+     *  The items are only moved when the vector grows if that can not throw
      */
-    ValueMap() {}
+    static_assert(std::is_nothrow_move_constructible<Item>::value, "members must be nothrow movable");
 
     /**
-     *  Copy constructor
+     *  Maps up to this size are searched linearly
+     */
+    static const size_t linear = 8;
+
+    /**
+     *  The available items, in insertion order, allocated in the active arena
+     */
+    std::pmr::vector<Item> _items;
+
+    /**
+     *  Hash index into the items, only used for larger maps
+     *
+     *  Every bucket holds the offset of an item plus one,
+     *  zero marks an empty bucket. The number of buckets
+     *  is a power of two, and at least twice the size.
+     */
+    std::pmr::vector<uint32_t> _index;
+
+    /**
+     *  Find the offset of an item
+     *
+     *  @param  key     the key to look for
+     *  @return offset of the item, or the size if not found
      */
-    ValueMap(const ValueMap& that) : _items(that._items) {}
+    size_t locate(std::string_view key) const
+    {
+        // small maps are simply scanned
+        if (_index.empty())
+        {
+            // look for the item with the given key
+            for (size_t i = 0; i < _items.size(); ++i) if (_items[i].first == key) return i;
+
+            // item not found
+            return _items.size();
+        }
+
+        // walk the buckets, starting at the one the hash points to
+        size_t mask = _index.size() - 1;
+        for (size_t bucket = std::hash<std::string_view>()(key) & mask; _index[bucket]; bucket = (bucket + 1) & mask)
+        {
+            // check whether this bucket holds our key
+            if (_items[_index[bucket] - 1].first == key) return _index[bucket] - 1;
+        }
+
+        // we reached an empty bucket, so the key does not exist
+        return _items.size();
+    }
 
     /**
-     *  Move constructor
+     *  Add an item to the hash index
+     *
+     *  @param  offset  offset of the item
      */
-    ValueMap(ValueMap&& that) : _items(std::move(that._items)) {}
+    void insert(size_t offset)
+    {
+        // find the first empty bucket
+        size_t mask = _index.size() - 1;
+        size_t bucket = std::hash<std::string_view>()(_items[offset].first) & mask;
+        while (_index[bucket]) bucket = (bucket + 1) & mask;
+
+        // store the offset
+        _index[bucket] = offset + 1;
+    }
+
+    /**
+     *  Update the hash index after an item was added at the end
+     */
+    void added()
+    {
+        // small maps do not need an index
+        if (_items.size() <= linear) return;
+
+        // if the index still has room we can just insert the item
+        if (_items.size() * 2 <= _index.size()) return insert(_items.size() - 1);
+
+        // rebuild the index with more buckets
+        size_t buckets = 32;
+        while (buckets < _items.size() * 2) buckets *= 2;
+        _index.assign(buckets, 0);
+
+        // and add all the items to it
+        for (size_t i = 0; i < _items.size(); ++i) insert(i);
+    }
+
+    /**
+     *  Add an item at the end, without checking whether the key exists
+     *
+     *  @param  key     the key of the item
+     *  @param  value   the value of the item
+     */
+    template <typename V>
+    void append(std::string_view key, V&& value)
+    {
+        // long keys are shared with other maps, if they are in the key table
+        const char *shared = Key::fits(key.size()) ? nullptr : KeyTable::intern(key);
+
+        // add the item
+        if (shared) _items.emplace_back(Key::shared(std::string_view(shared, key.size())), std::forward<V>(value));
+        else _items.emplace_back(key, std::forward<V>(value));
+        added();
+    }
+
+    /**
+     *  Add an item, unless its key already exists
+     *
+     *  @param  key     the key of the item
+     *  @param  value   the value of the item
+     */
+    void add(std::string_view key, const Value& value)
+    {
+        // ignore duplicate keys
+        if (locate(key) < _items.size()) return;
+
+        // add the item
+        append(key, value);
+    }
+
+    /**
+     *  Add all the items from a map or list
+     *
+     *  @param  items   the items to add
+     */
+    template <typename Items>
+    void add(const Items& items)
+    {
+        // allocate the storage once
+        _items.reserve(items.size());
+
+        // and add the items
+        for (const auto& item : items) add(item.first, item.second);
+    }
+
+public:
+    /**
+     *  Empty constructor
+     */
+    ValueMap() : _items(ValueArena::resource()), _index(ValueArena::resource()) {}
+
+    /**
+     *  Copy constructor
+     *
+     *  The copy is allocated in the arena that is active now
+     */
+    ValueMap(const ValueMap& that) : ValueImpl(that), _items(that._items, ValueArena::resource()), _index(that._index, ValueArena::resource()) {}
 
     /**
      *  Constructor with list of items
      */
-    ValueMap(const std::map<std::string, Value>& items) : _items(items) {}
+    ValueMap(const std::map<std::string, Value>& items) : ValueMap() { add(items); }
 
     /**
      *  Constructor with moveable list of items
      */
-    ValueMap(std::map<std::string, Value>&& items) : _items(std::move(items)) {}
+    ValueMap(std::map<std::string, Value>&& items) : ValueMap()
+    {
+        // allocate the storage once
+        _items.reserve(items.size());
+
+        // the keys are unique, so we can move the values over directly
+        for (auto& item : items) append(item.first, std::move(item.second));
+    }
 
     /**
      *  Constructor with initializer list
      */
-    ValueMap(const std::initializer_list<std::map<std::string, Value>::value_type>& items) : _items(items) {}
+    ValueMap(const std::initializer_list<std::map<std::string, Value>::value_type>& items) : ValueMap() { add(items); }
 
     /**
      *  Get the implementation type
@@ -75,7 +240,7 @@ public:
      */
     virtual ValueImpl* clone() const override
     {
-        return new ValueMap(_items);
+        return create<ValueMap>(*this);
     }
 
     /**
@@ -86,7 +251,10 @@ public:
      */
     virtual operator std::map<std::string, Value> () const override
     {
-        return _items;
+        // the keys are copied out of the arena
+        std::map<std::string, Value> result;
+        for (auto &item : _items) result.emplace(std::string(item.first.data(), item.first.size()), item.second);
+        return result;
     }
 
     /**
@@ -98,49 +266,56 @@ public:
     }
 
     /**
-     *  Retrieve value at given offset
+     *  Look up the value at the given key
      *
-     *  If no value exists at the given offset, a
-     *  null value will be returned instead.
+     *  If no value exists at the given key,
+     *  a nullptr is returned instead.
      */
-    virtual Value get(const std::string& key) const override
+    virtual const Value* find(std::string_view key) const override
     {
-        try
-        {
-            // if the element exists, return it
-            return _items.at(key);
-        }
-        catch (...)
-        {
-            // element does not exist, return null instead
-            return nullptr;
-        }
+        // look up the element
+        size_t offset = locate(key);
+
+        // expose the value if we found it
+        return offset < _items.size() ? &_items[offset].second : nullptr;
     }
 
     /**
-     *  Set value at the given key
-     *
-     *  This is only applicable for map values,
-     *  other implementation will ignore this.
+     *  Retrieve a modifiable value at the given key,
+     *  a null value is added if the key does not exist
      */
-    virtual ValueImpl& set(const std::string& key, const Value& value) override
+    virtual Value& member(std::string_view key) override
     {
-        // set property and allow chaining
-        _items[key] = value;
-        return *this;
+        // look up the element
+        size_t offset = locate(key);
+
+        // expose the value if we found it
+        if (offset < _items.size()) return _items[offset].second;
+
+        // add a new item at the end
+        append(key, nullptr);
+
+        // expose the new value
+        return _items.back().second;
     }
 
     /**
-     *  Set value at the given key
+     *  Look up the element at the given position, to iterate over it
+     *
+     *  The members are visited in insertion order.
      *
-     *  This is only applicable for map values,
-     *  other implementation will ignore this.
+     *  @param  index   position of the member
+     *  @param  key     the key of the member
+     *  @return the value of the member, or a nullptr after the last member
      */
-    virtual ValueImpl& set(const std::string& key, Value&& value) override
+    virtual const Value* at(size_t index, std::string_view& key) const override
     {
-        // move property and allow chaining
-        _items[key] = std::move(value);
-        return *this;
+        // check for a valid position
+        if (index >= _items.size()) return nullptr;
+
+        // expose the member
+        key = _items[index].first;
+        return &_items[index].second;
     }
 
     /**
@@ -151,38 +326,125 @@ public:
         // Create a json object
         struct json_object *output = json_object_new_object();
 
-        // Loop through our items and append them to the json object
-        for (auto &item : _items) json_object_object_add(output, item.first.data(), item.second.toJson());
+        // Loop through our items and append them to the json object, which wants null terminated keys
+        for (auto &item : _items) json_object_object_add(output, std::string(item.first.data(), item.first.size()).data(), item.second.toJson());
 
         // Return the json array
         return output;
     }
 
+    /**
+     *  Append the value to a json string
+     *
+     *  @param  output
+     */
+    virtual void toJson(std::string& output) const override
+    {
+        // Open the json object
+        output.push_back('{');
+
+        // Append our items, separated by commas
+        for (size_t i = 0; i < _items.size(); ++i)
+        {
+            if (i > 0) output.push_back(',');
+            JsonWriter::string(output, _items[i].first.data(), _items[i].first.size());
+            output.push_back(':');
+            _items[i].second.toJsonString(output);
+        }
+
+        // Close the json object
+        output.push_back('}');
+    }
+
+    /**
+     *  Append the value to a MessagePack buffer
+     *
+     *  @param  output
+     */
+    virtual void toMsgPack(std::string& output) const override
+    {
+        // The header holds the number of members, which follow it
+        MsgPackWriter::map(output, _items.size());
+        for (auto &item : _items)
+        {
+            MsgPackWriter::string(output, item.first.data(), item.first.size());
+            item.second.toMsgPack(output);
+        }
+    }
+
+    /**
+     *  Append the value to a CBOR buffer
+     *
+     *  @param  output
+     */
+    virtual void toCbor(std::string& output) const override
+    {
+        // The header holds the number of members, which follow it
+        CborWriter::map(output, _items.size());
+        for (auto &item : _items)
+        {
+            CborWriter::string(output, item.first.data(), item.first.size());
+            item.second.toCbor(output);
+        }
+    }
+
+    /**
+     *  Write the value to a snapshot
+     *
+     *  @param  writer
+     *  @return the slot describing the value
+     */
+    virtual SnapshotSlot toSnapshot(SnapshotWriter& writer) const override
+    {
+        // The keys and values are written first, the map refers to them
+        std::vector<SnapshotMember> members;
+        members.reserve(_items.size());
+        for (auto &item : _items) members.push_back(SnapshotMember{ writer.string(item.first.data(), item.first.size()), writer.value(item.second) });
+        return writer.map(members);
+    }
+
+    /**
+     *  Calculate the structural hash
+     *
+     *  The member hashes are added up, so that maps with
+     *  the same members in a different order have the same hash.
+     *
+     *  @param  seed
+     *  @return uint64_t
+     */
+    virtual uint64_t hash(uint64_t seed) const override
+    {
+        // add up the hashes of the members
+        uint64_t members = 0;
+        for (auto &item : _items) members += Hash::mix(Hash::bytes(seed, item.first.data(), item.first.size()), item.second.hash(seed));
+        return Hash::mix(Hash::mix(Hash::mix(seed, ValueMapType), _items.size()), members);
+    }
+
     /**
      *  Comparison operator
      */
     virtual bool operator==(const ValueImpl &that) const override
     {
+        // A map is always equal to itself
+        if (&that == this) return true;
+
         // Start off with checking if we are the same type
         if (that.type() != ValueMapType) return false;
 
         // Check if we're the same size
         if (that.size() != size()) return false;
 
-        // Cast that to a std::map
-        std::map<std::string, Value> m = that;
-
-        // Loop through the map and look everything up in the other map
-        for (const auto &member : m)
+        // Loop through our members and look them up in the other map, without copying them
+        for (const auto &member : _items)
         {
             // Look for an item with the current key in the other map
-            const auto &iter = _items.find(member.first);
+            const auto *value = that.find(member.first);
 
             // If we didn't find it then we are obviously not equal
-            if (iter == _items.end()) return false;
+            if (value == nullptr) return false;
 
             // If our items aren't equal, neither are we
-            if (iter->second != member.second) return false;
+            if (*value != member.second) return false;
         }
 
         // If we made it here we know that we are the same
@@ -193,4 +455,4 @@ public:
 /**
  *  End namespace
  */
-}
\ No newline at end of file
+}
@@ -0,0 +1,283 @@
+/**
+ *  ValuePath.cpp
+ *
+ *  Implementation file for paths into documents
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/ValuePath.h"
+#include "../include/Value.h"
+#include <charconv>
+#include <climits>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Record an error
+ *
+ *  @param  error       the error to fill in
+ *  @param  offset      where in the path the error was found
+ *  @param  reason      description of the error
+ *  @return always false
+ */
+static bool fail(JsonError& error, size_t offset, const char *reason)
+{
+    error.offset = offset;
+    error.reason = reason;
+    return false;
+}
+
+/**
+ *  Constructor
+ *
+ *  @param  path        json pointer or dotted path
+ */
+ValuePath::ValuePath(std::string_view path)
+{
+    // the reason is not needed
+    JsonError error;
+    parse(path, error);
+}
+
+/**
+ *  Constructor
+ *
+ *  @param  path        json pointer or dotted path
+ *  @param  error       the reason why the path is invalid
+ */
+ValuePath::ValuePath(std::string_view path, JsonError& error)
+{
+    parse(path, error);
+}
+
+/**
+ *  Parse a path
+ *
+ *  @param  path        json pointer or dotted path
+ *  @param  error       the reason why the path is invalid
+ */
+void ValuePath::parse(std::string_view path, JsonError& error)
+{
+    // an empty path refers to the whole document
+    if (path.empty()) return;
+
+    // json pointers start with a slash, the rest is dotted
+    _valid = path[0] == '/' ? parsePointer(path, error) : parseDotted(path, error);
+    if (_valid) return;
+
+    // an invalid path has no steps
+    _keys.clear();
+    _steps.clear();
+}
+
+/**
+ *  The index a token refers to
+ *
+ *  @param  token
+ *  @return the index, or none if the token is not a valid index
+ */
+size_t ValuePath::index(std::string_view token)
+{
+    // the item after the last one
+    if (token == "-") return past;
+
+    // only digits are allowed, without leading zeros
+    if (token.empty() || (token[0] == '0' && token.size() > 1)) return none;
+    for (char c : token) if (c < '0' || c > '9') return none;
+
+    // the number must fit
+    size_t result;
+    auto converted = std::from_chars(token.data(), token.data() + token.size(), result);
+    return converted.ec == std::errc() && result < past ? result : none;
+}
+
+/**
+ *  Add a step, its key was already appended to the keys
+ *
+ *  @param  offset      where the key starts
+ *  @param  element     is it only an index?
+ */
+void ValuePath::add(size_t offset, bool element)
+{
+    // the key runs up to the end of the keys
+    size_t size = _keys.size() - offset;
+    _steps.push_back(Step{ offset, size, index(std::string_view(_keys.data() + offset, size)), element });
+}
+
+/**
+ *  Parse a json pointer
+ *
+ *  @param  path        the pointer, including the leading slash
+ *  @param  error       the error that was found
+ *  @return was the pointer valid?
+ */
+bool ValuePath::parsePointer(std::string_view path, JsonError& error)
+{
+    // every slash starts a new token
+    for (size_t i = 1, offset = 0; i <= path.size(); ++i)
+    {
+        // the end of the token
+        if (i == path.size() || path[i] == '/')
+        {
+            add(offset, false);
+            offset = _keys.size();
+            continue;
+        }
+
+        // most characters are copied as they are
+        if (path[i] != '~') { _keys.push_back(path[i]); continue; }
+
+        // a tilde escapes a tilde or a slash
+        if (i + 1 == path.size() || (path[i + 1] != '0' && path[i + 1] != '1')) return fail(error, i, "invalid escape sequence");
+        _keys.push_back(path[++i] == '0' ? '~' : '/');
+    }
+
+    // the pointer was valid
+    return true;
+}
+
+/**
+ *  Parse a dotted path
+ *
+ *  @param  path        the path
+ *  @param  error       the error that was found
+ *  @return was the path valid?
+ */
+bool ValuePath::parseDotted(std::string_view path, JsonError& error)
+{
+    // parse the segments between the dots
+    for (size_t i = 0; true; ++i)
+    {
+        // every segment starts with a key
+        size_t start = i;
+        while (i < path.size() && path[i] != '.' && path[i] != '[') ++i;
+
+        // only the first segment may start with an index instead
+        if (i > start)
+        {
+            _keys.append(path.data() + start, i - start);
+            add(_keys.size() - (i - start), false);
+        }
+        else if (start > 0 || i == path.size() || path[i] != '[') return fail(error, start, "empty key");
+
+        // the key may be followed by indices
+        while (i < path.size() && path[i] == '[')
+        {
+            // find the closing bracket
+            size_t first = ++i;
+            while (i < path.size() && path[i] != ']') ++i;
+            if (i == path.size()) return fail(error, first - 1, "unterminated index");
+
+            // the brackets must hold a valid index
+            std::string_view token = path.substr(first, i - first);
+            if (token == "-" || index(token) == none) return fail(error, first, "invalid index");
+
+            // add the step
+            _keys.append(token.data(), token.size());
+            add(_keys.size() - token.size(), true);
+            ++i;
+        }
+
+        // the path is complete, or continues after a dot
+        if (i == path.size()) return true;
+        if (path[i] != '.') return fail(error, i, "expected '.' or '['");
+    }
+}
+
+/**
+ *  Look up the value the path points to
+ *
+ *  @param  document    the document to look in
+ *  @return the value, or a nullptr if it does not exist
+ */
+const Value* ValuePath::find(const Value& document) const
+{
+    // an invalid path does not point to anything
+    if (!_valid) return nullptr;
+
+    // walk down the document
+    const Value *current = &document;
+    for (const auto &step : _steps)
+    {
+        // the step is applied to a vector or a map
+        switch (current->type())
+        {
+        case ValueVectorType:
+            // vectors need an index that exists
+            if (step.index >= INT_MAX) return nullptr;
+            current = current->find((int)step.index);
+            break;
+
+        case ValueMapType:
+            // maps need a key
+            if (step.element) return nullptr;
+            current = current->find(key(step));
+            break;
+
+        default:
+            // other values have no elements
+            return nullptr;
+        }
+
+        // stop when the element does not exist
+        if (current == nullptr) return nullptr;
+    }
+
+    // we found the value
+    return current;
+}
+
+/**
+ *  Look up the value the path points to, so that it can be modified
+ *
+ *  @param  document    the document to modify
+ *  @return the value
+ */
+Value& ValuePath::resolveOrCreate(Value& document) const
+{
+    // hand out a scratch value for invalid paths, anything written to it is lost
+    static thread_local Value ignored;
+    if (!_valid) return ignored = Value();
+
+    // walk down the document
+    Value *current = &document;
+    for (const auto &step : _steps)
+    {
+        // an index can be used for an existing vector, a vector is added for an element
+        if ((current->_type == ValueVectorType && step.index != none) || step.element)
+        {
+            // items can only be added at the end, so the index must exist or be the next one
+            size_t size = current->_type == ValueVectorType ? current->_impl->size() : 0;
+            size_t index = step.index == past ? size : step.index;
+            if (index > size) return ignored = Value();
+
+            // we must be of the vector type, and we are about to be modified
+            if (current->_type != ValueVectorType) *current = std::vector<Value>();
+            current->detach();
+
+            // the vector grows when the index is the next one
+            current = &current->_impl->member(index);
+        }
+        else
+        {
+            // we must be of the map type, and we are about to be modified
+            if (current->_type != ValueMapType) *current = std::map<std::string, Value>();
+            current->detach();
+
+            // the member is added when it does not exist yet
+            current = &current->_impl->member(key(step));
+        }
+    }
+
+    // expose the value
+    return *current;
+}
+
+/**
+ *  End namespace
+ */
+}
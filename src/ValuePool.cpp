@@ -0,0 +1,181 @@
+/**
+ *  ValuePool.cpp
+ *
+ *  Implementation file for the pool of value implementations
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "ValuePool.h"
+
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+#include <pthread.h>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  The pool of the current thread
+ */
+thread_local ValuePool *ValuePool::_local = nullptr;
+
+/**
+ *  The pools of threads that exited, and the lock that protects them,
+ *  which is only used when a thread gets or gives up its pool
+ */
+static std::mutex abandonedLock;
+static ValuePool *abandoned = nullptr;
+
+/**
+ *  The pool of the current thread, which is created when needed
+ *
+ *  @return ValuePool
+ */
+ValuePool *ValuePool::local()
+{
+    // most of the time the thread already has a pool
+    if (_local) return _local;
+
+    // the key makes sure that abandon() is called when the thread exits, this
+    // happens after the thread local objects, which may still release values
+    static pthread_key_t exitKey = []() {
+        pthread_key_t key;
+        pthread_key_create(&key, abandon);
+        return key;
+    }();
+
+    {
+        // take over the pool of a thread that exited, if there is one
+        std::lock_guard<std::mutex> lock(abandonedLock);
+        if (abandoned)
+        {
+            _local = abandoned;
+            abandoned = abandoned->_next;
+        }
+    }
+
+    // otherwise we need a new one
+    if (!_local) _local = new ValuePool();
+
+    // make sure we hear about it when the thread exits
+    pthread_setspecific(exitKey, _local);
+    return _local;
+}
+
+/**
+ *  Called when a thread exits, the pool is kept for the next thread
+ *
+ *  @param  pool
+ */
+void ValuePool::abandon(void *pool)
+{
+    // the thread no longer has a pool
+    _local = nullptr;
+
+    // add the pool to the ones that can be taken over
+    std::lock_guard<std::mutex> lock(abandonedLock);
+    static_cast<ValuePool *>(pool)->_next = abandoned;
+    abandoned = static_cast<ValuePool *>(pool);
+}
+
+/**
+ *  Allocate a block when no free block is available
+ *
+ *  @param  sizeClass   the size class to allocate from
+ *  @param  size        the size of the blocks
+ *  @return the block
+ */
+void *ValuePool::refill(SizeClass& sizeClass, size_t size)
+{
+    // take over the blocks that other threads gave back
+    Block *remote = sizeClass.remote.exchange(nullptr, std::memory_order_acquire);
+    if (remote)
+    {
+        sizeClass.free = remote->next;
+        return remote;
+    }
+
+    // start a new chunk when the current one is used up
+    if (sizeClass.current + size > sizeClass.end)
+    {
+        // the chunk is aligned on its size, so that blocks can find it
+        auto *chunk = static_cast<Chunk *>(::operator new(chunkSize, std::align_val_t(chunkSize)));
+        chunk->owner = this;
+        chunk->next = _chunks;
+        _chunks = chunk;
+
+        // the blocks follow the start of the chunk
+        sizeClass.current = reinterpret_cast<char *>(chunk + 1);
+        sizeClass.end = reinterpret_cast<char *>(chunk) + chunkSize;
+    }
+
+    // hand out the next block from the chunk
+    void *result = sizeClass.current;
+    sizeClass.current += size;
+    return result;
+}
+
+/**
+ *  Allocate memory for an implementation
+ *
+ *  @param  size
+ *  @return the memory
+ */
+void *ValuePool::allocate(size_t size)
+{
+    // big objects come straight from the heap
+    size_t index = (size - 1) / granularity;
+    if (index >= classes) return ::operator new(size);
+
+    // use a free block if there is one
+    ValuePool *pool = local();
+    SizeClass &sizeClass = pool->_classes[index];
+    if (Block *block = sizeClass.free)
+    {
+        sizeClass.free = block->next;
+        return block;
+    }
+
+    // otherwise find a new one
+    return pool->refill(sizeClass, (index + 1) * granularity);
+}
+
+/**
+ *  Give memory back, from any thread
+ *
+ *  @param  pointer     memory returned by allocate()
+ *  @param  size        the size that was passed to allocate()
+ */
+void ValuePool::deallocate(void *pointer, size_t size)
+{
+    // big objects came straight from the heap
+    size_t index = (size - 1) / granularity;
+    if (index >= classes) return ::operator delete(pointer);
+
+    // the chunk tells us which pool the block belongs to
+    auto *chunk = reinterpret_cast<Chunk *>(reinterpret_cast<uintptr_t>(pointer) & ~uintptr_t(chunkSize - 1));
+    SizeClass &sizeClass = chunk->owner->_classes[index];
+    auto *block = static_cast<Block *>(pointer);
+
+    // blocks of our own pool go straight back on the free list
+    if (chunk->owner == _local)
+    {
+        block->next = sizeClass.free;
+        sizeClass.free = block;
+        return;
+    }
+
+    // blocks of other pools are pushed on their list of returned blocks
+    block->next = sizeClass.remote.load(std::memory_order_relaxed);
+    while (!sizeClass.remote.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {}
+}
+
+/**
+ *  End namespace
+ */
+}
@@ -0,0 +1,154 @@
+/**
+ *  ValuePool.h
+ *
+ *  Pool of memory blocks for the value implementations that are
+ *  allocated on the heap. Every thread has its own pool, so creating
+ *  and dropping values does not contend on a lock. A block that is
+ *  released by another thread than the one that allocated it is
+ *  handed back to the pool it came from through a lock-free list.
+ *
+ *  The blocks are carved from chunks, which are never given back to
+ *  the system. When a thread exits its pool is kept, and reused by
+ *  the next thread that needs a pool.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Class definition
+ */
+class ValuePool
+{
+private:
+    /**
+     *  Size and alignment of the chunks the blocks are carved from
+     */
+    static constexpr size_t chunkSize = 64 * 1024;
+
+    /**
+     *  Block sizes are rounded up to a multiple of this
+     */
+    static constexpr size_t granularity = 16;
+
+    /**
+     *  Number of block sizes, bigger allocations go to the heap
+     */
+    static constexpr size_t classes = 8;
+
+    /**
+     *  A block that is not in use
+     */
+    struct Block
+    {
+        Block *next;
+    };
+
+    /**
+     *  The start of every chunk, so that the pool of a block can be found
+     */
+    struct alignas(64) Chunk
+    {
+        ValuePool *owner;
+        Chunk *next;
+    };
+
+    /**
+     *  The free blocks of a single size
+     */
+    struct SizeClass
+    {
+        /**
+         *  Blocks released by the owning thread
+         */
+        Block *free = nullptr;
+
+        /**
+         *  The part of the newest chunk that was not yet handed out
+         */
+        char *current = nullptr;
+        char *end = nullptr;
+
+        /**
+         *  Blocks released by other threads, on a cache line of their own
+         */
+        alignas(64) std::atomic<Block *> remote{nullptr};
+    };
+
+    /**
+     *  The free blocks, per size
+     */
+    SizeClass _classes[classes];
+
+    /**
+     *  All chunks of the pool
+     */
+    Chunk *_chunks = nullptr;
+
+    /**
+     *  Next pool in the list of pools without a thread
+     */
+    ValuePool *_next = nullptr;
+
+    /**
+     *  The pool of the current thread
+     */
+    static thread_local ValuePool *_local;
+
+    /**
+     *  The pool of the current thread, which is created when needed
+     *
+     *  @return ValuePool
+     */
+    static ValuePool *local();
+
+    /**
+     *  Called when a thread exits, the pool is kept for the next thread
+     *
+     *  @param  pool
+     */
+    static void abandon(void *pool);
+
+    /**
+     *  Allocate a block when no free block is available
+     *
+     *  @param  sizeClass   the size class to allocate from
+     *  @param  size        the size of the blocks
+     *  @return the block
+     */
+    void *refill(SizeClass& sizeClass, size_t size);
+
+public:
+    /**
+     *  Allocate memory for an implementation
+     *
+     *  @param  size
+     *  @return the memory
+     */
+    static void *allocate(size_t size);
+
+    /**
+     *  Give memory back, from any thread
+     *
+     *  @param  pointer     memory returned by allocate()
+     *  @param  size        the size that was passed to allocate()
+     */
+    static void deallocate(void *pointer, size_t size);
+};
+
+/**
+ *  End namespace
+ */
+}
@@ -0,0 +1,575 @@
+/**
+ *  ValueSnapshot.h
+ *
+ *  Map or array that is read in place from a binary snapshot.
+ *
+ *  Nothing is decoded until it is accessed. Members of a map are
+ *  looked up with a binary search on the keys in the snapshot,
+ *  and the elements are turned into values in small blocks, so
+ *  a lookup in a large container does not decode all of it.
+ *  Strings refer to the snapshot instead of being copied.
+ *
+ *  The snapshot is never written to. The first modification
+ *  turns the value into a regular map or vector instead.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include "../include/ValueImpl.h"
+#include "../include/Value.h"
+#include "Snapshot.h"
+#include "SnapshotWriter.h"
+#include "ValueStringView.h"
+#include "ValueVector.h"
+#include "ValueMap.h"
+#include "JsonWriter.h"
+#include "MsgPackWriter.h"
+#include "CborWriter.h"
+#include "Hash.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  Set up class
+ */
+class ValueSnapshot : public ValueImpl
+{
+private:
+    /**
+     *  The snapshot we are part of
+     */
+    std::shared_ptr<const Snapshot> _snapshot;
+
+    /**
+     *  The slot that describes us
+     */
+    const SnapshotSlot *_slot;
+
+    /**
+     *  Number of elements that are decoded together
+     */
+    static constexpr size_t blockSize = 64;
+
+    /**
+     *  A block of decoded elements
+     */
+    struct Block
+    {
+        std::once_flag once;
+        std::unique_ptr<Value[]> items;
+    };
+
+    /**
+     *  The blocks of decoded elements, decoding happens only
+     *  once, even when the value is shared between threads
+     */
+    mutable std::once_flag _once;
+    mutable std::unique_ptr<Block[]> _blocks;
+
+    /**
+     *  Regular map or vector that replaces us after the first modification
+     */
+    ValueImpl *_copy = nullptr;
+
+    /**
+     *  The hash for the default seed, zero when it is not yet known
+     */
+    mutable std::atomic<uint64_t> _hash{0};
+
+    /**
+     *  The members of a map
+     *
+     *  @return SnapshotMember
+     */
+    const SnapshotMember *members() const
+    {
+        return reinterpret_cast<const SnapshotMember *>(_snapshot->at(_slot->offset, 0));
+    }
+
+    /**
+     *  The key of a map member
+     *
+     *  @param  index   position of the member
+     *  @return the key, which is empty if it does not fit in the snapshot
+     */
+    std::string_view key(size_t index) const
+    {
+        // look up the key
+        const auto &slot = members()[index].key;
+        const char *data = _snapshot->at(slot.offset, slot.size);
+
+        // expose it, if it is valid
+        return data && slot.type == ValueStringType ? std::string_view(data, slot.size) : std::string_view();
+    }
+
+    /**
+     *  The slot of an element
+     *
+     *  @param  index   position of the element
+     *  @return the slot of the array item, or of the map value
+     */
+    const SnapshotSlot& slot(size_t index) const
+    {
+        if (_slot->type == ValueMapType) return members()[index].value;
+        return reinterpret_cast<const SnapshotSlot *>(_snapshot->at(_slot->offset, 0))[index];
+    }
+
+    /**
+     *  A decoded element
+     *
+     *  @param  index   position of the element, which must exist
+     *  @return Value
+     */
+    const Value& item(size_t index) const
+    {
+        // create the blocks the first time an element is needed
+        std::call_once(_once, [this]() { _blocks.reset(new Block[(_slot->size + blockSize - 1) / blockSize]); });
+
+        // decode the block that holds the element, the first time it is needed
+        Block &block = _blocks[index / blockSize];
+        std::call_once(block.once, [this, &block, index]() {
+            size_t first = index - index % blockSize;
+            size_t count = std::min(blockSize, _slot->size - first);
+
+            // the elements are allocated in the same place as we are
+            ValueArena arena(this->arena());
+            block.items.reset(new Value[count]);
+            for (size_t i = 0; i < count; ++i) block.items[i] = decode(_snapshot, slot(first + i), _slot->offset);
+        });
+
+        // expose the element
+        return block.items[index % blockSize];
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  @param  snapshot    the snapshot we are part of
+     *  @param  slot        the slot that describes us, which must have been checked
+     */
+    ValueSnapshot(const std::shared_ptr<const Snapshot>& snapshot, const SnapshotSlot *slot) : _snapshot(snapshot), _slot(slot) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~ValueSnapshot()
+    {
+        if (_copy) _copy->release();
+    }
+
+    /**
+     *  Turn a slot into a value
+     *
+     *  Slots that refer to data outside the snapshot become null.
+     *  The elements of a container are written before the container
+     *  itself, so a container that is not empty must start before
+     *  the container that holds it. Other containers also become
+     *  null, so that a damaged snapshot can not hold itself.
+     *
+     *  @param  snapshot    the snapshot the slot is part of
+     *  @param  slot        the slot to decode
+     *  @param  limit       offset of the container that holds the slot
+     *  @return Value
+     */
+    static Value decode(const std::shared_ptr<const Snapshot>& snapshot, const SnapshotSlot& slot, uint64_t limit = UINT64_MAX)
+    {
+        switch (slot.type)
+        {
+            case ValueBoolType:     return slot.integer != 0;
+            case ValueInt32Type:    return (int32_t)slot.integer;
+            case ValueInt64Type:    return (int64_t)slot.integer;
+            case ValueDoubleType:   return slot.number;
+            case ValueStringType:
+            {
+                // the string must fit in the snapshot, and it keeps the snapshot alive
+                const char *data = snapshot->at(slot.offset, slot.size);
+                return data ? Value(ValueImpl::create<ValueStringView>(std::string_view(data, slot.size), snapshot)) : Value();
+            }
+            case ValueVectorType:
+            case ValueMapType:
+            {
+                // the elements, and the sorted positions of map members, must fit in the snapshot
+                uint64_t size = slot.type == ValueVectorType ? slot.size * sizeof(SnapshotSlot) : slot.size * (sizeof(SnapshotMember) + sizeof(uint32_t));
+                if (slot.offset % alignof(SnapshotSlot) != 0 || !snapshot->at(slot.offset, size)) return Value();
+
+                // and they must come before the container that holds them
+                if (slot.size > 0 && slot.offset >= limit) return Value();
+
+                // the container is decoded when it is accessed
+                return Value(ValueImpl::create<ValueSnapshot>(snapshot, &slot));
+            }
+            default:                return Value();
+        }
+    }
+
+    /**
+     *  Get the implementation type
+     */
+    virtual ValueType type() const override
+    {
+        return (ValueType)_slot->type;
+    }
+
+    /**
+     *  Clone the implementation
+     *
+     *  This creates a regular map or vector, that shares the elements with us
+     */
+    virtual ValueImpl* clone() const override
+    {
+        // a modified value has already been copied
+        if (_copy) return _copy->clone();
+
+        // the copy is allocated in the same place as we are
+        ValueArena arena(this->arena());
+
+        // copy the items of an array
+        if (_slot->type == ValueVectorType)
+        {
+            auto *vector = ValueImpl::create<ValueVector>();
+            vector->reserve(_slot->size);
+            for (size_t i = 0; i < _slot->size; ++i) vector->append() = item(i);
+            return vector;
+        }
+
+        // copy the members of a map
+        auto *map = ValueImpl::create<ValueMap>();
+        for (size_t i = 0; i < _slot->size; ++i) map->member(key(i)) = item(i);
+        return map;
+    }
+
+    /**
+     *  Convert the value to a vector
+     */
+    virtual operator std::vector<Value> () const override
+    {
+        // a modified value has already been copied
+        if (_copy) return *_copy;
+
+        // only arrays have items
+        std::vector<Value> result;
+        if (_slot->type != ValueVectorType) return result;
+
+        // copy the items, which shares them
+        result.reserve(_slot->size);
+        for (size_t i = 0; i < _slot->size; ++i) result.push_back(item(i));
+        return result;
+    }
+
+    /**
+     *  Convert the value to a map
+     */
+    virtual operator std::map<std::string, Value> () const override
+    {
+        // a modified value has already been copied
+        if (_copy) return *_copy;
+
+        // only maps have members
+        std::map<std::string, Value> result;
+        if (_slot->type != ValueMapType) return result;
+
+        // copy the members, which shares their values
+        for (size_t i = 0; i < _slot->size; ++i) result.emplace(key(i), item(i));
+        return result;
+    }
+
+    /**
+     *  Get the number of items
+     */
+    virtual size_t size() const override
+    {
+        return _copy ? _copy->size() : _slot->size;
+    }
+
+    /**
+     *  Look up the value at the given offset
+     */
+    virtual const Value* find(size_t index) const override
+    {
+        // a modified value has already been copied
+        if (_copy) return _copy->find(index);
+
+        // only arrays have items at an offset
+        if (_slot->type != ValueVectorType || index >= _slot->size) return nullptr;
+
+        // expose the item
+        return &item(index);
+    }
+
+    /**
+     *  Retrieve a modifiable value at the given offset
+     */
+    virtual Value& member(size_t index) override
+    {
+        // we can not modify the snapshot, so we modify a copy
+        if (!_copy) _copy = clone();
+        return _copy->member(index);
+    }
+
+    /**
+     *  Look up the value at the given key
+     */
+    virtual const Value* find(std::string_view key) const override
+    {
+        // a modified value has already been copied
+        if (_copy) return _copy->find(key);
+
+        // only maps have members
+        if (_slot->type != ValueMapType) return nullptr;
+
+        // the positions of the members sorted by key follow the members
+        auto *sorted = reinterpret_cast<const uint32_t *>(members() + _slot->size);
+
+        // binary search for the key
+        size_t low = 0, high = _slot->size;
+        while (low < high)
+        {
+            // compare the key in the middle
+            size_t middle = low + (high - low) / 2;
+            uint32_t position = sorted[middle];
+            if (position >= _slot->size) return nullptr;
+            int compared = this->key(position).compare(key);
+
+            // expose the value if we found it, or continue in the right half
+            if (compared == 0) return &item(position);
+            if (compared < 0) low = middle + 1;
+            else high = middle;
+        }
+
+        // the key does not exist
+        return nullptr;
+    }
+
+    /**
+     *  Retrieve a modifiable value at the given key
+     */
+    virtual Value& member(std::string_view key) override
+    {
+        // we can not modify the snapshot, so we modify a copy
+        if (!_copy) _copy = clone();
+        return _copy->member(key);
+    }
+
+    /**
+     *  Look up the element at the given position, to iterate over it
+     */
+    virtual const Value* at(size_t index, std::string_view& key) const override
+    {
+        // a modified value has already been copied
+        if (_copy) return _copy->at(index, key);
+
+        // check for a valid position
+        if (index >= _slot->size) return nullptr;
+
+        // expose the element
+        key = _slot->type == ValueMapType ? this->key(index) : std::string_view();
+        return &item(index);
+    }
+
+    /**
+     *  Turn the value into a json compatible type
+     */
+    virtual struct json_object *toJson() const override
+    {
+        // a modified value has already been copied
+        if (_copy) return _copy->toJson();
+
+        // append the items of an array
+        if (_slot->type == ValueVectorType)
+        {
+            struct json_object *output = json_object_new_array();
+            for (size_t i = 0; i < _slot->size; ++i) json_object_array_add(output, item(i).toJson());
+            return output;
+        }
+
+        // add the members of a map, which wants null terminated keys
+        struct json_object *output = json_object_new_object();
+        for (size_t i = 0; i < _slot->size; ++i) json_object_object_add(output, std::string(key(i)).data(), item(i).toJson());
+        return output;
+    }
+
+    /**
+     *  Append the value to a json string
+     *
+     *  @param  output
+     */
+    virtual void toJson(std::string& output) const override
+    {
+        // a modified value has already been copied
+        if (_copy) return _copy->toJson(output);
+
+        // open the array or object
+        bool array = _slot->type == ValueVectorType;
+        output.push_back(array ? '[' : '{');
+
+        // append the elements, separated by commas
+        for (size_t i = 0; i < _slot->size; ++i)
+        {
+            if (i > 0) output.push_back(',');
+            if (!array)
+            {
+                std::string_view key = this->key(i);
+                JsonWriter::string(output, key.data(), key.size());
+                output.push_back(':');
+            }
+            item(i).toJsonString(output);
+        }
+
+        // close the array or object
+        output.push_back(array ? ']' : '}');
+    }
+
+    /**
+     *  Append the value to a MessagePack buffer
+     *
+     *  @param  output
+     */
+    virtual void toMsgPack(std::string& output) const override
+    {
+        // a modified value has already been copied
+        if (_copy) return _copy->toMsgPack(output);
+
+        // the header holds the number of elements, which follow it
+        bool array = _slot->type == ValueVectorType;
+        if (array) MsgPackWriter::array(output, _slot->size);
+        else MsgPackWriter::map(output, _slot->size);
+
+        // map members start with their key
+        for (size_t i = 0; i < _slot->size; ++i)
+        {
+            if (!array) MsgPackWriter::string(output, key(i).data(), key(i).size());
+            item(i).toMsgPack(output);
+        }
+    }
+
+    /**
+     *  Append the value to a CBOR buffer
+     *
+     *  @param  output
+     */
+    virtual void toCbor(std::string& output) const override
+    {
+        // a modified value has already been copied
+        if (_copy) return _copy->toCbor(output);
+
+        // the header holds the number of elements, which follow it
+        bool array = _slot->type == ValueVectorType;
+        if (array) CborWriter::array(output, _slot->size);
+        else CborWriter::map(output, _slot->size);
+
+        // map members start with their key
+        for (size_t i = 0; i < _slot->size; ++i)
+        {
+            if (!array) CborWriter::string(output, key(i).data(), key(i).size());
+            item(i).toCbor(output);
+        }
+    }
+
+    /**
+     *  Write the value to a snapshot
+     *
+     *  @param  writer
+     *  @return the slot describing the value
+     */
+    virtual SnapshotSlot toSnapshot(SnapshotWriter& writer) const override
+    {
+        // a modified value has already been copied
+        if (_copy) return _copy->toSnapshot(writer);
+
+        // the items of an array are written first, the array refers to them
+        if (_slot->type == ValueVectorType)
+        {
+            std::vector<SnapshotSlot> items;
+            items.reserve(_slot->size);
+            for (size_t i = 0; i < _slot->size; ++i) items.push_back(writer.value(item(i)));
+            return writer.array(items);
+        }
+
+        // the keys and values of a map are written first, the map refers to them
+        std::vector<SnapshotMember> members;
+        members.reserve(_slot->size);
+        for (size_t i = 0; i < _slot->size; ++i) members.push_back(SnapshotMember{ writer.string(key(i).data(), key(i).size()), writer.value(item(i)) });
+        return writer.map(members);
+    }
+
+    /**
+     *  Calculate the structural hash
+     *
+     *  This gives the same outcome as for a regular map or vector
+     *
+     *  @param  seed
+     *  @return uint64_t
+     */
+    virtual uint64_t hash(uint64_t seed) const override
+    {
+        // a modified value has already been copied
+        if (_copy) return _copy->hash(seed);
+
+        // the hash for the default seed may already be known
+        uint64_t result = seed == 0 ? _hash.load(std::memory_order_relaxed) : 0;
+        if (result) return result;
+
+        // the items of an array are hashed in order
+        if (_slot->type == ValueVectorType)
+        {
+            result = Hash::mix(Hash::mix(seed, ValueVectorType), _slot->size);
+            for (size_t i = 0; i < _slot->size; ++i) result = Hash::mix(result, item(i).hash(seed));
+        }
+        else
+        {
+            // the hashes of the map members are added up
+            uint64_t members = 0;
+            for (size_t i = 0; i < _slot->size; ++i) members += Hash::mix(Hash::bytes(seed, key(i).data(), key(i).size()), item(i).hash(seed));
+            result = Hash::mix(Hash::mix(Hash::mix(seed, ValueMapType), _slot->size), members);
+        }
+
+        // remember the hash for the default seed
+        if (seed == 0) _hash.store(result, std::memory_order_relaxed);
+        return result;
+    }
+
+    /**
+     *  Comparison operator
+     */
+    virtual bool operator==(const ValueImpl &that) const override
+    {
+        // a modified value has already been copied
+        if (_copy) return *_copy == that;
+
+        // a value is always equal to itself
+        if (&that == this) return true;
+
+        // the other value must be of the same type and size
+        if (that.type() != type() || that.size() != _slot->size) return false;
+
+        // compare the elements, as soon as one is different we are not equal
+        for (size_t i = 0; i < _slot->size; ++i)
+        {
+            // look up the element in the other value
+            const Value *other = _slot->type == ValueMapType ? that.find(key(i)) : that.find(i);
+            if (other == nullptr || *other != item(i)) return false;
+        }
+
+        // all elements are the same
+        return true;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
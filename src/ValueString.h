@@ -11,7 +11,9 @@
  */
 #pragma once
 
-#include "../include/ValueImpl.h"
+#include "ValueStringBase.h"
+#include "SmallString.h"
+#include <string_view>
 
 /**
  *  Set up namespace
@@ -21,152 +23,57 @@ namespace Variant {
 /**
  *  String value implementation
  */
-class ValueString : public ValueImpl
+class ValueString : public ValueStringBase
 {
 private:
     /**
-     *  Value of this value
+     *  Value of this value, stored inline when it is short,
+     *  and otherwise allocated in the active arena
      */
-    std::string _value;
+    SmallString<24> _value;
 public:
     /**
      *  Construct new string value
      *
      *  @param  value
+     *  @param  length
      */
-    ValueString(const char* value) : _value(value) {}
+    ValueString(const char* value, size_t length) : _value(std::string_view(value, length), ValueArena::resource()) {}
 
     /**
      *  Construct new string value
      *
      *  @param  value
      */
-    ValueString(const char* value, size_t length) : _value(value, length) {}
+    ValueString(std::string_view value) : _value(value, ValueArena::resource()) {}
 
     /**
-     *  Construct new string value
+     *  Copy constructor
      *
-     *  @param  value
-     */
-    ValueString(const std::string& value) : _value(value) {}
-
-    /**
-     *  Construct new string value
+     *  The copy is allocated in the arena that is active now
      *
-     *  @param  value
+     *  @param  that
      */
-    ValueString(std::string&& value) : _value(std::move(value)) {}
-
-    /**
-     *  Get the implementation type
-     */
-    virtual ValueType type() const override
-    {
-        return ValueStringType;
-    }
+    ValueString(const ValueString& that) : ValueStringBase(that), _value(that._value, ValueArena::resource()) {}
 
     /**
      *  Clone the implementation
      */
     virtual ValueImpl* clone() const override
     {
-        return new ValueString(_value);
-    }
-
-    /**
-     *  Convert the value to a boolean
-     */
-    virtual operator bool () const override
-    {
-        // cast to a number and see whether this is false
-        try
-        {
-            return std::stod(_value);
-        }
-        catch (...)
-        {
-            return 0;
-        }
-    }
-
-    /**
-     *  Convert the value to a number
-     */
-    virtual operator int32_t () const override
-    {
-        try
-        {
-            return std::stoi(_value);
-        }
-        catch (...)
-        {
-            return 0;
-        }
+        return create<ValueString>(*this);
     }
 
     /**
-     *  Convert the value to a number
+     *  The bytes of the string, without copying them
      */
-    virtual operator int64_t () const override
-    {
-        try
-        {
-            return std::stoll(_value);
-        }
-        catch (...)
-        {
-            return 0;
-        }
-    }
-
-    /**
-     *  Convert the value to a number
-     */
-    virtual operator double () const override
-    {
-        try
-        {
-            return std::stod(_value);
-        }
-        catch (...)
-        {
-            return 0.0;
-        }
-    }
-
-    /**
-     *  Convert the value to a string
-     */
-    virtual operator std::string () const override
+    virtual std::string_view view() const override
     {
         return _value;
     }
-
-    /**
-     *  Turn the value into a json compatible type
-     */
-    virtual struct json_object *toJson() const override
-    {
-        return json_object_new_string_len(_value.data(), _value.size());
-    }
-
-    /**
-     *  Comparison operator
-     */
-    virtual bool operator==(const ValueImpl &that) const override
-    {
-        // Start off with checking if we are the same type
-        if (that.type() != ValueStringType) return false;
-
-        // Cast that to a std::string
-        std::string s = that;
-
-        // Compare the two strings
-        return _value == s;
-    }
 };
 
 /**
  *  End namespace
  */
-}
\ No newline at end of file
+}
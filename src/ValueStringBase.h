@@ -0,0 +1,202 @@
+/**
+ *  ValueStringBase.h
+ *
+ *  Base class for the implementations of the string type, that only
+ *  differ in where the bytes are stored. Everything else works on
+ *  the bytes that view() exposes.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include "../include/ValueImpl.h"
+#include "JsonWriter.h"
+#include "MsgPackWriter.h"
+#include "CborWriter.h"
+#include "Hash.h"
+#include "NumberParser.h"
+#include "SnapshotWriter.h"
+#include <string_view>
+#include <string>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  String value base class
+ */
+class ValueStringBase : public ValueImpl
+{
+public:
+    /**
+     *  Get the implementation type
+     */
+    virtual ValueType type() const override
+    {
+        return ValueStringType;
+    }
+
+    /**
+     *  Convert the value to a boolean
+     *
+     *  Strings that start with a non-zero number are true
+     */
+    virtual operator bool () const override
+    {
+        return NumberParser::prefix<double>(view()) != 0.0;
+    }
+
+    /**
+     *  Convert the value to a number
+     */
+    virtual operator int32_t () const override
+    {
+        return NumberParser::prefix<int32_t>(view());
+    }
+
+    /**
+     *  Convert the value to a number
+     */
+    virtual operator int64_t () const override
+    {
+        return NumberParser::prefix<int64_t>(view());
+    }
+
+    /**
+     *  Convert the value to a number
+     */
+    virtual operator double () const override
+    {
+        return NumberParser::prefix<double>(view());
+    }
+
+    /**
+     *  Convert the value to a number, if it holds nothing but a number
+     *
+     *  @param  result
+     *  @return was the value converted?
+     */
+    virtual bool tryCast(int32_t& result) const override
+    {
+        return NumberParser::complete(view(), result);
+    }
+
+    /**
+     *  Convert the value to a number, if it holds nothing but a number
+     *
+     *  @param  result
+     *  @return was the value converted?
+     */
+    virtual bool tryCast(int64_t& result) const override
+    {
+        return NumberParser::complete(view(), result);
+    }
+
+    /**
+     *  Convert the value to a number, if it holds nothing but a number
+     *
+     *  @param  result
+     *  @return was the value converted?
+     */
+    virtual bool tryCast(double& result) const override
+    {
+        return NumberParser::complete(view(), result);
+    }
+
+    /**
+     *  Convert the value to a string
+     */
+    virtual operator std::string () const override
+    {
+        return std::string(view());
+    }
+
+    /**
+     *  Turn the value into a json compatible type
+     */
+    virtual struct json_object *toJson() const override
+    {
+        auto value = view();
+        return json_object_new_string_len(value.data(), value.size());
+    }
+
+    /**
+     *  Append the value to a json string
+     *
+     *  @param  output
+     */
+    virtual void toJson(std::string& output) const override
+    {
+        auto value = view();
+        JsonWriter::string(output, value.data(), value.size());
+    }
+
+    /**
+     *  Append the value to a MessagePack buffer
+     *
+     *  @param  output
+     */
+    virtual void toMsgPack(std::string& output) const override
+    {
+        auto value = view();
+        MsgPackWriter::string(output, value.data(), value.size());
+    }
+
+    /**
+     *  Append the value to a CBOR buffer
+     *
+     *  @param  output
+     */
+    virtual void toCbor(std::string& output) const override
+    {
+        auto value = view();
+        CborWriter::string(output, value.data(), value.size());
+    }
+
+    /**
+     *  Write the value to a snapshot
+     *
+     *  @param  writer
+     *  @return the slot describing the value
+     */
+    virtual SnapshotSlot toSnapshot(SnapshotWriter& writer) const override
+    {
+        auto value = view();
+        return writer.string(value.data(), value.size());
+    }
+
+    /**
+     *  Calculate the structural hash
+     *
+     *  @param  seed
+     *  @return uint64_t
+     */
+    virtual uint64_t hash(uint64_t seed) const override
+    {
+        auto value = view();
+        return Hash::bytes(Hash::mix(seed, ValueStringType), value.data(), value.size());
+    }
+
+    /**
+     *  Comparison operator
+     */
+    virtual bool operator==(const ValueImpl &that) const override
+    {
+        // Start off with checking if we are the same type
+        if (that.type() != ValueStringType) return false;
+
+        // Compare the bytes of the two strings, without copying them
+        return view() == that.view();
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
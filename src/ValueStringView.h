@@ -0,0 +1,70 @@
+/**
+ *  ValueStringView.h
+ *
+ *  Value of string type that refers to bytes owned by someone else,
+ *  which must stay valid for as long as the value is used. This is
+ *  used to decode binary formats without copying every string.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include "ValueStringBase.h"
+#include <string_view>
+#include <memory>
+
+/**
+ *  Set up namespace
+ */
+namespace Variant {
+
+/**
+ *  String view implementation
+ */
+class ValueStringView : public ValueStringBase
+{
+private:
+    /**
+     *  The bytes we refer to
+     */
+    std::string_view _value;
+
+    /**
+     *  Optional owner of the bytes, which is kept alive by us
+     */
+    std::shared_ptr<const void> _owner;
+
+public:
+    /**
+     *  Construct new string view
+     *
+     *  @param  value
+     *  @param  owner   optional owner of the bytes
+     */
+    ValueStringView(std::string_view value, std::shared_ptr<const void> owner = nullptr) : _value(value), _owner(std::move(owner)) {}
+
+    /**
+     *  Clone the implementation
+     */
+    virtual ValueImpl* clone() const override
+    {
+        return create<ValueStringView>(_value, _owner);
+    }
+
+    /**
+     *  The bytes of the string, without copying them
+     */
+    virtual std::string_view view() const override
+    {
+        return _value;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}
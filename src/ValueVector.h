@@ -14,6 +14,12 @@
 
 #include "../include/ValueImpl.h"
 #include "../include/Value.h"
+#include "MsgPackWriter.h"
+#include "CborWriter.h"
+#include "Hash.h"
+#include "SnapshotWriter.h"
+#include <iterator>
+#include <memory_resource>
 #include <vector>
 
 /**
@@ -28,39 +34,58 @@ class ValueVector : public ValueImpl
 {
 private:
     /**
-     *  The available items
+     *  The available items, allocated in the active arena
      */
-    std::vector<Value> _items;
+    std::pmr::vector<Value> _items;
+
 public:
     /**
      *  Empty constructor
      */
-    ValueVector() {}
+    ValueVector() : _items(ValueArena::resource()) {}
 
     /**
      *  Copy constructor
+     *
+     *  The copy is allocated in the arena that is active now
      */
-    ValueVector(const ValueVector& that) : _items(that._items) {}
-
-    /**
-     *  Move constructor
-     */
-    ValueVector(ValueVector&& that) : _items(std::move(that._items)) {}
+    ValueVector(const ValueVector& that) : ValueImpl(that), _items(that._items, ValueArena::resource()) {}
 
     /**
      *  Constructor with list of items
      */
-    ValueVector(const std::vector<Value>& items) : _items(items) {}
+    ValueVector(const std::vector<Value>& items) : _items(items.begin(), items.end(), ValueArena::resource()) {}
 
     /**
      *  Constructor with moveable list of items
      */
-    ValueVector(std::vector<Value>&& items) : _items(std::move(items)) {}
+    ValueVector(std::vector<Value>&& items) : _items(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()), ValueArena::resource()) {}
 
     /**
      *  Constructor with initializer list
      */
-    ValueVector(const std::initializer_list<Value>& items) : _items(items) {}
+    ValueVector(const std::initializer_list<Value>& items) : _items(items, ValueArena::resource()) {}
+
+    /**
+     *  Reserve room for a number of items
+     *
+     *  @param  size
+     */
+    void reserve(size_t size)
+    {
+        _items.reserve(size);
+    }
+
+    /**
+     *  Add a null value at the end, to be filled in by the caller
+     *
+     *  @return the new value
+     */
+    Value& append()
+    {
+        // add the value and expose it
+        return _items.emplace_back();
+    }
 
     /**
      *  Get the implementation type
@@ -75,7 +100,7 @@ public:
      */
     virtual ValueImpl* clone() const override
     {
-        return new ValueVector(_items);
+        return create<ValueVector>(*this);
     }
 
     /**
@@ -86,7 +111,7 @@ public:
      */
     virtual operator std::vector<Value> () const override
     {
-        return _items;
+        return std::vector<Value>(_items.begin(), _items.end());
     }
 
     /**
@@ -98,50 +123,44 @@ public:
     }
 
     /**
-     *  Retrieve value at given offset
+     *  Look up the value at the given offset
      *
-     *  If no value exists at the given offset, a
-     *  null value will be returned instead.
+     *  If no value exists at the given offset,
+     *  a nullptr is returned instead.
      */
-    virtual Value get(size_t index) const override
+    virtual const Value* find(size_t index) const override
     {
-        // check for a valid index and return the value
-        if (index < size()) return _items[index];
+        // check for a valid index and expose the value
+        if (index < _items.size()) return &_items[index];
 
         // invalid offset
         return nullptr;
     }
 
     /**
-     *  Set value at the given offset
-     *
-     *  This is only applicable for array values,
-     *  other implementation will ignore this.
+     *  Retrieve a modifiable value at the given offset,
+     *  the vector is grown with null values if needed
      */
-    virtual ValueImpl& set(size_t index, const Value& value) override
+    virtual Value& member(size_t index) override
     {
         // make sure that the requested offset is available
-        while (index > size() - 1) _items.push_back(nullptr);
+        if (index >= _items.size()) _items.resize(index + 1);
 
-        // set the value and allow chaining
-        _items[index] = value;
-        return *this;
+        // expose the value
+        return _items[index];
     }
 
     /**
-     *  Set value at the given offset
+     *  Look up the element at the given position, to iterate over it
      *
-     *  This is only applicable for array values,
-     *  other implementation will ignore this.
+     *  @param  index   position of the element
+     *  @param  key     cleared, items have no key
+     *  @return the item, or a nullptr after the last item
      */
-    virtual ValueImpl& set(size_t index, Value&& value) override
+    virtual const Value* at(size_t index, std::string_view& key) const override
     {
-        // make sure that the requested offset is available
-        while (index > size() - 1) _items.push_back(nullptr);
-
-        // move the value and allow chaining
-        _items[index] = std::move(value);
-        return *this;
+        key = std::string_view();
+        return find(index);
     }
 
     /**
@@ -159,27 +178,100 @@ public:
         return output;
     }
 
+    /**
+     *  Append the value to a json string
+     *
+     *  @param  output
+     */
+    virtual void toJson(std::string& output) const override
+    {
+        // Open the json array
+        output.push_back('[');
+
+        // Append our items, separated by commas
+        for (size_t i = 0; i < _items.size(); ++i)
+        {
+            if (i > 0) output.push_back(',');
+            _items[i].toJsonString(output);
+        }
+
+        // Close the json array
+        output.push_back(']');
+    }
+
+    /**
+     *  Append the value to a MessagePack buffer
+     *
+     *  @param  output
+     */
+    virtual void toMsgPack(std::string& output) const override
+    {
+        // The header holds the number of items, which follow it
+        MsgPackWriter::array(output, _items.size());
+        for (auto &item : _items) item.toMsgPack(output);
+    }
+
+    /**
+     *  Append the value to a CBOR buffer
+     *
+     *  @param  output
+     */
+    virtual void toCbor(std::string& output) const override
+    {
+        // The header holds the number of items, which follow it
+        CborWriter::array(output, _items.size());
+        for (auto &item : _items) item.toCbor(output);
+    }
+
+    /**
+     *  Write the value to a snapshot
+     *
+     *  @param  writer
+     *  @return the slot describing the value
+     */
+    virtual SnapshotSlot toSnapshot(SnapshotWriter& writer) const override
+    {
+        // The items are written first, the array refers to them
+        std::vector<SnapshotSlot> items;
+        items.reserve(_items.size());
+        for (auto &item : _items) items.push_back(writer.value(item));
+        return writer.array(items);
+    }
+
+    /**
+     *  Calculate the structural hash
+     *
+     *  @param  seed
+     *  @return uint64_t
+     */
+    virtual uint64_t hash(uint64_t seed) const override
+    {
+        // the items are hashed in order
+        uint64_t result = Hash::mix(Hash::mix(seed, ValueVectorType), _items.size());
+        for (auto &item : _items) result = Hash::mix(result, item.hash(seed));
+        return result;
+    }
+
     /**
      *  Comparison operator
      */
     virtual bool operator==(const ValueImpl &that) const override
     {
+        // A vector is always equal to itself
+        if (&that == this) return true;
+
         // Start off with checking if we are the same type
         if (that.type() != ValueVectorType) return false;
 
         // Check if we're the same size
         if (that.size() != size()) return false;
 
-        // Cast that to a std::vector
-        std::vector<Value> v = that;
-
-        // Store the length of the vector
-        std::vector<Value>::size_type len = v.size();
-
         // Loop through the vector, as soon as we see something that is different we return false
-        for (std::vector<Value>::size_type i = 0; i < len; ++i)
+        for (size_t i = 0; i < _items.size(); ++i)
         {
-            if (v[i] != _items[i]) return false;
+            // Look up the item in the other vector, without copying it
+            const Value *other = that.find(i);
+            if (other == nullptr || *other != _items[i]) return false;
         }
 
         // If we made it here we know that we are the same
@@ -0,0 +1,148 @@
+/**
+ *  Cbor.cpp
+ *
+ *  Round trips, the examples of RFC 8949, borrowed strings, truncated
+ *  input and invalid input for CBOR
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Check.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Parse data that must be valid
+ *
+ *  @param  data
+ *  @return Value
+ */
+static Value parse(const std::string& data)
+{
+    JsonError error;
+    Value result = Value::fromCbor(data, error);
+    CHECK(!error);
+    return result;
+}
+
+/**
+ *  Check that data is rejected, both when strings are copied and when they are borrowed
+ *
+ *  @param  data
+ *  @param  reason      the expected reason
+ *  @param  offset      the expected offset
+ */
+static void reject(const std::string& data, const char *reason, size_t offset)
+{
+    JsonError copied, borrowed;
+    Value result = Value::fromCbor(data, copied);
+    Value view = Value::fromCborView(data, borrowed);
+    CHECK(copied && borrowed && result.type() == ValueNullType && view.type() == ValueNullType);
+    if (!copied || !borrowed) return;
+    CHECK(std::strcmp(copied.reason, reason) == 0 && std::strcmp(borrowed.reason, reason) == 0);
+    CHECK(copied.offset == offset && borrowed.offset == offset);
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // a document with every type, and every size of header
+    Value document;
+    document["null"] = nullptr;
+    document["bool"] = false;
+    document["int32"] = (int32_t)-100000;
+    document["small"] = (int32_t)7;
+    document["int64"] = (int64_t)-7;
+    document["double"] = 7.0;
+    document["strings"] = std::vector<Value>{ "", "short", std::string(23, 's'), std::string(24, 'm'), std::string(300, 'l'), std::string(70000, 'x') };
+    for (int i = 0; i < 70000; ++i) document["long"][i] = i;
+    for (int i = 0; i < 30; ++i) document["map"][std::to_string(i)] = std::vector<Value>{ i };
+
+    // the round trip gives the same value with the same types, and the same bytes
+    std::string data = document.toCbor();
+    Value copy = parse(data);
+    CHECK(copy == document);
+    CHECK(copy.toCbor() == data);
+    const Value &constant = copy;
+    CHECK(constant["int32"].type() == ValueInt32Type);
+    CHECK(constant["int64"].type() == ValueInt64Type);
+    CHECK(constant["double"].type() == ValueDoubleType);
+
+    // borrowed strings refer to the data, and give the same value
+    Value view = Value::fromCborView(data);
+    CHECK(view == document && document == view);
+    std::string_view text = static_cast<const Value&>(view)["strings"][4].view();
+    CHECK(text.data() >= data.data() && text.data() + text.size() <= data.data() + data.size());
+
+    // appending to a buffer
+    std::string buffer = "prefix";
+    document.toCbor(buffer);
+    CHECK(buffer == "prefix" + data);
+
+    // encodings from the examples in the RFC
+    CHECK(Value(0).toCbor() == std::string("\x00", 1));
+    CHECK(Value(23).toCbor() == "\x17");
+    CHECK(Value(24).toCbor() == "\x18\x18");
+    CHECK(Value(1000).toCbor() == "\x19\x03\xe8");
+    CHECK(Value(-1).toCbor() == "\x20");
+    CHECK(Value(-1000).toCbor() == "\x39\x03\xe7");
+    CHECK(Value(nullptr).toCbor() == "\xf6");
+    CHECK(Value(true).toCbor() == "\xf5");
+    CHECK(Value("a").toCbor() == "\x61\x61");
+    CHECK(Value(std::vector<Value>{ 1, std::vector<Value>{ 2, 3 }, std::vector<Value>{ 4, 5 } }).toCbor() == "\x83\x01\x82\x02\x03\x82\x04\x05");
+
+    // 64 bit integers always use the full width, so that they are 64 bit again when parsed
+    CHECK(Value((int64_t)1).toCbor() == std::string("\x1b\x00\x00\x00\x00\x00\x00\x00\x01", 9));
+
+    // and decoding them
+    CHECK(parse(std::string("\x1b\x00\x00\x00\x01\x00\x00\x00\x00", 9)) == Value((int64_t)4294967296));
+    CHECK(parse("\x1b\xff\xff\xff\xff\xff\xff\xff\xff").type() == ValueDoubleType);
+    CHECK(parse(std::string("\xf9\x3e\x00", 3)) == Value(1.5));
+    CHECK(parse(std::string("\xf9\x7c\x00", 3)) == Value(INFINITY));
+    CHECK(parse(std::string("\xfa\x47\xc3\x50\x00", 5)) == Value(100000.0));
+    CHECK(parse("\xfb\x3f\xf1\x99\x99\x99\x99\x99\x9a") == Value(1.1));
+    CHECK(parse("\xc1\x1a\x51\x4b\x67\xb0") == Value(1363896240));
+    CHECK(parse("\x5f\x42\x01\x02\x43\x03\x04\x05\xff").view() == "\x01\x02\x03\x04\x05");
+    CHECK(parse("\x7f\x65strea\x64ming\xff").view() == "streaming");
+    CHECK(parse("\x9f\xff") == Value(std::vector<Value>()));
+    CHECK(parse("\x9f\x01\x82\x02\x03\x9f\x04\x05\xff\xff").toJsonString() == "[1,[2,3],[4,5]]");
+    CHECK(parse("\xbf\x61\x61\x01\x61\x62\x9f\x02\x03\xff\xff").toJsonString() == "{\"a\":1,\"b\":[2,3]}");
+
+    // an indefinite string is joined, so it can not be borrowed
+    CHECK(Value::fromCborView("\x7f\x65strea\x64ming\xff").view() == "streaming");
+
+    // every proper prefix is incomplete
+    std::string sample = Value::fromJson("{\"a\":[1,-1.5,\"text\",null,true],\"b\":{\"c\":\"d\"},\"e\":9223372036854775807}").toCbor();
+    for (size_t size = 0; size < sample.size(); ++size)
+    {
+        JsonError error;
+        Value::fromCbor(sample.substr(0, size), error);
+        CHECK(error && std::strcmp(error.reason, "unexpected end of input") == 0);
+        CHECK(error.offset <= size);
+    }
+
+    // invalid input
+    reject("", "unexpected end of input", 0);
+    reject("\x65" "abc", "unexpected end of input", 1);
+    reject("\x9b\xff\xff\xff\xff\xff\xff\xff\xff", "unexpected end of input", 9);
+    reject("\x9f\x01", "unexpected end of input", 2);
+    reject("\xc1", "unexpected end of input", 1);
+    reject("\x1c", "invalid additional information", 0);
+    reject("\x1f", "unexpected indefinite length", 1);
+    reject("\xf8\x20", "unsupported simple value", 2);
+    reject("\xa1\x01\x01", "map key is not a string", 1);
+    reject("\x5f\x61\x61\xff", "invalid string chunk", 2);
+    reject("\xf6\xf6", "unexpected data after value", 1);
+    reject(std::string(2000, '\x81'), "nesting too deep", 1025);
+
+    // done
+    return report("Cbor");
+}
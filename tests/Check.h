@@ -0,0 +1,37 @@
+/**
+ *  Check.h
+ *
+ *  Minimal helpers for the test programs. A check that fails is
+ *  reported with its location, and makes the program fail.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Include guard
+ */
+#pragma once
+
+#include <iostream>
+
+/**
+ *  Number of checks that failed
+ */
+static int failures = 0;
+
+/**
+ *  Check a condition, and report it when it does not hold
+ */
+#define CHECK(condition) do { if (!(condition)) { std::cerr << __FILE__ << ":" << __LINE__ << ": " << #condition << std::endl; ++failures; } } while (0)
+
+/**
+ *  Report the outcome of a test program
+ *
+ *  @param  name    name of the test
+ *  @return the exit code
+ */
+inline int report(const char *name)
+{
+    std::cout << name << (failures ? ": FAILED" : ": OK") << std::endl;
+    return failures != 0;
+}
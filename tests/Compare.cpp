@@ -0,0 +1,134 @@
+/**
+ *  Compare.cpp
+ *
+ *  Ordering values, and checking that values that are equal also
+ *  have the same hash, no matter how they were made
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Check.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Are two values equal, equivalent, and do they have the same hash?
+ *  @param  a
+ *  @param  b
+ *  @return bool
+ */
+static bool same(const Value& a, const Value& b)
+{
+    return a == b && b == a && a.compare(b) == 0 && b.compare(a) == 0 && a.hash() == b.hash() && a.hash(7) == b.hash(7);
+}
+
+/**
+ *  Is the first value ordered before the second?
+ *  @param  a
+ *  @param  b
+ *  @return bool
+ */
+static bool before(const Value& a, const Value& b)
+{
+    return a != b && a < b && b > a && a.compare(b) < 0 && b.compare(a) > 0;
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // the order of members does not matter for maps
+    Value first;
+    first["a"] = 1;
+    first["b"] = "two";
+    first["c"] = std::vector<Value>{ 3 };
+    Value second;
+    second["c"] = std::vector<Value>{ 3 };
+    second["a"] = 1;
+    second["b"] = "two";
+    CHECK(same(first, second));
+    CHECK(same(Value::fromJson(R"({"x":{"p":1,"q":2},"y":0})"), Value::fromJson(R"({"y":0,"x":{"q":2,"p":1}})")));
+
+    // but the values of the members do, and so do their keys
+    second["b"] = "three";
+    CHECK(first != second && first.compare(second) != 0);
+    CHECK(Value::fromJson(R"({"a":1})") != Value::fromJson(R"({"b":1})"));
+
+    // not-a-number is equal to itself, whatever its sign or payload, and goes after all other numbers
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    CHECK(same(Value(nan), Value(nan)));
+    CHECK(same(Value(nan), Value(-nan)));
+    CHECK(same(Value(nan), Value(std::numeric_limits<double>::signaling_NaN())));
+    CHECK(before(Value(std::numeric_limits<double>::infinity()), Value(nan)));
+    CHECK(before(Value(INT64_MAX), Value(nan)));
+    CHECK(before(Value(nan), Value("")));
+    CHECK(same(Value(std::vector<Value>{ nan }), Value(std::vector<Value>{ nan })));
+
+    // zero and negative zero are the same
+    CHECK(same(Value(0.0), Value(-0.0)));
+
+    // numbers of a different type are never equal, but are ordered by their value first
+    CHECK(Value(1) != Value((int64_t)1) && Value(1) != Value(1.0));
+    CHECK(before(Value(1), Value((int64_t)1)));
+    CHECK(before(Value((int64_t)1), Value(1.0)));
+    CHECK(before(Value(1.5), Value(2)));
+    CHECK(before(Value(-3), Value(-2.5)));
+    CHECK(before(Value((int64_t)INT32_MIN - 1), Value(INT32_MIN)));
+
+    // without losing precision when integers are compared with doubles
+    CHECK(before(Value(INT64_MAX), Value(9223372036854775808.0)));
+    CHECK(before(Value(9007199254740992.0), Value((int64_t)9007199254740993)));
+    CHECK(before(Value((int64_t)9007199254740992), Value(9007199254740992.0)));
+    CHECK(before(Value(-9223372036854775808.0 * 2), Value(INT64_MIN)));
+
+    // empty strings are equal however they are made, and go before all other strings
+    CHECK(same(Value(""), Value(std::string())));
+    CHECK(same(Value(""), Value::fromJson("\"\"")));
+    CHECK(same(Value(""), Value::fromMsgPack(Value("").toMsgPack())));
+    CHECK(before(Value(""), Value("a")));
+    CHECK(before(Value("a"), Value("ab")));
+    CHECK(before(Value(std::string("a\0", 2)), Value("a\x01")));
+    CHECK(Value("").hash() != Value().hash());
+
+    // the order of the types
+    std::vector<Value> ordered = { Value(), Value(false), Value(true), Value(-1.0), Value(0), Value(""), Value("z"), Value(std::vector<Value>{}), Value(std::vector<Value>{ 0 }), Value(std::vector<Value>{ 0, 0 }), Value(std::vector<Value>{ 1 }), Value::fromJson("{}"), Value::fromJson(R"({"b":1})"), Value::fromJson(R"({"a":1,"b":1})") };
+    for (size_t i = 0; i + 1 < ordered.size(); ++i) CHECK(before(ordered[i], ordered[i + 1]));
+
+    // the same document, made in all possible ways
+    std::string json = R"({"id":12345,"name":"name","empty":"","price":1.25,"big":-9007199254740993,"flags":[true,false,null],"nested":{"list":[1,[2,3],{}],"text":"a somewhat longer string that is stored out of line"}})";
+    Value parsed = Value::fromJson(json);
+    std::string snapshot = parsed.toSnapshot();
+    std::vector<uint64_t> aligned(snapshot.size() / sizeof(uint64_t) + 1);
+    std::memcpy(aligned.data(), snapshot.data(), snapshot.size());
+    std::string cbor = parsed.toCbor();
+    std::vector<Value> documents = { Value::fromJsonLazy(json), Value::fromMsgPack(parsed.toMsgPack()), Value::fromCbor(cbor), Value::fromCborView(cbor), Value::fromSnapshot(std::string_view((const char *)aligned.data(), snapshot.size())) };
+    for (auto &document : documents) CHECK(same(parsed, document));
+    for (auto &document : documents) CHECK(same(documents[0], document));
+
+    // also after one member has been read and the others have not
+    Value lazy = Value::fromJsonLazy(json);
+    CHECK(static_cast<const Value&>(lazy)["nested"]["list"][0] == Value((int64_t)1));
+    CHECK(same(lazy, parsed));
+
+    // and when they are modified in the same way
+    for (auto &document : documents) document["nested"]["extra"] = 1;
+    for (auto &document : documents) CHECK(same(documents[0], document) && !same(document, parsed));
+
+    // values can be used as keys
+    std::unordered_set<Value> set = { first, Value(nan), Value(-nan), Value(0.0), Value(-0.0), Value(""), Value(std::string()), parsed, documents[0], Value::fromJsonLazy(json) };
+    CHECK(set.size() == 6);
+    CHECK(set.count(Value::fromJson(json)) == 1 && set.count(Value(1)) == 0);
+
+    // done
+    return report("Compare");
+}
@@ -0,0 +1,83 @@
+/**
+ *  Conversions.cpp
+ *
+ *  Converting strings to numbers: the casts read the same numbers as
+ *  strtoll() and strtod(), and tryCast() only accepts strings that
+ *  hold nothing but a number
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "Check.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // doubles are read just like strtod() reads them, including hexadecimal numbers and whitespace
+    const std::vector<std::string> doubles = { "12.5abc", "  12.5", "\t\n7", "+3", "-4.25e2", ".5", "5.", "0x10", "-0x1p3", "0X1.8p1", "0x1p-2 ", "0x", "0xg", "0x-1", "inf", "-Infinity", "+-1", "abc", "", "1e3x" };
+    for (auto &input : doubles) CHECK((double)Value(input) == std::strtod(input.c_str(), nullptr));
+    CHECK(std::isnan((double)Value("nan")));
+
+    // integers are read in base 10, like strtoll() does with base 10
+    const std::vector<std::string> integers = { "  42x", "+7", "-15", "0x10", "12.9", "007", "abc", "", "+-1", "-9223372036854775808", "9223372036854775807" };
+    for (auto &input : integers) CHECK((int64_t)Value(input) == std::strtoll(input.c_str(), nullptr, 10));
+    CHECK((int32_t)Value("-2147483648") == INT32_MIN);
+
+    // numbers that do not fit are zero, like std::stoll() and std::stod() used to give by throwing
+    CHECK((int64_t)Value("9223372036854775808") == 0);
+    CHECK((int32_t)Value("2147483648") == 0);
+    CHECK((double)Value("1e400") == 0.0);
+
+    // strings are true when they start with a number that is not zero
+    CHECK((bool)Value("0.5") && (bool)Value("-1x") && (bool)Value("0x1"));
+    CHECK(!(bool)Value("0.0") && !(bool)Value("abc") && !(bool)Value(""));
+
+    // tryCast() accepts strings that hold nothing but a number
+    int32_t small = 0;
+    int64_t large = 0;
+    double number = 0;
+    CHECK(Value(" 42 ").tryCast(small) && small == 42);
+    CHECK(Value("-9223372036854775808").tryCast(large) && large == INT64_MIN);
+    CHECK(Value("0x1p-2").tryCast(number) && number == 0.25);
+    CHECK(Value("\t-1.5e3\n").tryCast(number) && number == -1500.0);
+
+    // and rejects everything else, leaving the result alone
+    const std::vector<std::string> invalid = { "", "   ", "abc", "12abc", "1 2", "+-1", "--1", "0x", "12.5.1", "1e", "- 1" };
+    for (auto &input : invalid)
+    {
+        small = 7;
+        large = 7;
+        number = 7.0;
+        CHECK(!Value(input).tryCast(small) && small == 7);
+        CHECK(!Value(input).tryCast(large) && large == 7);
+        CHECK(!Value(input).tryCast(number) && number == 7.0);
+    }
+
+    // integers must be written in base 10, and fit in the type
+    CHECK(!Value("12.5").tryCast(large) && large == 7);
+    CHECK(!Value("0x10").tryCast(large) && large == 7);
+    CHECK(!Value("2147483648").tryCast(small) && small == 7);
+    CHECK(Value("2147483648").tryCast(large) && large == 2147483648LL);
+    CHECK(!Value("9223372036854775808").tryCast(large));
+
+    // other types are converted when the number fits
+    CHECK(Value(2.0).tryCast(small) && small == 2);
+    CHECK(!Value(2.5).tryCast(small) && small == 2);
+    CHECK(!Value((int64_t)1 << 40).tryCast(small) && small == 2);
+    CHECK(Value(true).tryCast(small) && small == 1);
+    CHECK(Value(3).tryCast(number) && number == 3.0);
+    CHECK(!Value().tryCast(small) && !Value(std::vector<Value>{ 1 }).tryCast(small));
+
+    // done
+    return report("Conversions");
+}
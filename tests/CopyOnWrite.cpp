@@ -0,0 +1,93 @@
+/**
+ *  CopyOnWrite.cpp
+ *
+ *  Copies of a value share their strings, vectors and maps until
+ *  one of them is modified, also when the modification is made
+ *  through a member that was created before the copy
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Check.h"
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // a copy is not changed when the original is
+    Value document;
+    document["a"] = 1;
+    document["list"][0] = "x";
+    Value copy = document;
+    document["a"] = 2;
+    document["list"][0] = "y";
+    CHECK(copy["a"].value() == Value(1) && document["a"].value() == Value(2));
+    CHECK(copy["list"][0].view() == "x" && document["list"][0].view() == "y");
+
+    // nor the original when the copy is
+    copy["list"][1] = "z";
+    CHECK(document["list"].value().size() == 1 && copy["list"].value().size() == 2);
+
+    // copies share their data until they are modified, reading through a member does not modify anything
+    Value shared = document;
+    auto reader = shared["a"];
+    CHECK((int)reader == 2);
+    CHECK(reader.view().empty());
+    CHECK(static_cast<const Value&>(shared).find("list") == static_cast<const Value&>(document).find("list"));
+
+    // a member that was created before a copy is made modifies only the value it was taken from
+    auto member = document["a"];
+    Value later = document;
+    member = 3;
+    CHECK(document["a"].value() == Value(3));
+    CHECK(later["a"].value() == Value(2));
+    CHECK(static_cast<const Value&>(later).find("list") != static_cast<const Value&>(document).find("list"));
+
+    // the same for elements of an array, and for members of members
+    Value list;
+    list[0] = 1;
+    auto element = list[0];
+    Value listCopy = list;
+    element = 2;
+    CHECK(list[0].value() == Value(2) && listCopy[0].value() == Value(1));
+    Value nested;
+    nested["a"]["b"] = 1;
+    Value nestedCopy = nested;
+    nested["a"]["b"] = 2;
+    CHECK(nested["a"]["b"].value() == Value(2) && nestedCopy["a"]["b"].value() == Value(1));
+
+    // a value can be assigned to one of its own members, which holds the value as it was
+    Value self;
+    self["name"] = "self";
+    self["self"] = self;
+    const Value &constant = self;
+    CHECK(constant["self"]["name"].view() == "self");
+    CHECK(constant["self"]["self"].type() == ValueNullType);
+    CHECK(self.toJsonString() == "{\"name\":\"self\",\"self\":{\"name\":\"self\"}}");
+
+    // also more than once, and in arrays
+    self["again"] = self;
+    CHECK(constant["again"]["self"]["name"].view() == "self");
+    CHECK(constant["again"]["again"].type() == ValueNullType);
+    Value array;
+    array[0] = 1;
+    array[1] = array;
+    CHECK(array.toJsonString() == "[1,[1]]");
+
+    // a member still works when the value it was taken from has become something else
+    Value changed;
+    auto orphan = changed["a"];
+    changed = 5;
+    orphan = 1;
+    CHECK(changed.type() == ValueMapType && changed["a"].value() == Value(1));
+
+    // done
+    return report("CopyOnWrite");
+}
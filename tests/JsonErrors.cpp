@@ -0,0 +1,82 @@
+/**
+ *  JsonErrors.cpp
+ *
+ *  Errors that are reported while parsing json, by fromJson() and
+ *  by parseJson() with a handler
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "../include/JsonHandler.h"
+#include "Check.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Handler that stops at a given key
+ */
+class Stopper : public JsonHandler
+{
+public:
+    virtual JsonAction onKey(std::string_view key) override
+    {
+        return key == "stop" ? JsonStop : JsonVisit;
+    }
+};
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // a literal null is not an error
+    JsonError error;
+    Value value = Value::fromJson("null", error);
+    CHECK(!error && value.type() == ValueNullType);
+
+    // an invalid document is, even though it also results in null
+    value = Value::fromJson("nil", error);
+    CHECK(error && value.type() == ValueNullType);
+
+    // a successful parse clears an earlier error
+    value = Value::fromJson("[1]", error);
+    CHECK(!error && error.offset == 0 && value.size() == 1);
+
+    // the offset of an error deep inside a large document
+    std::string json = "[";
+    for (int i = 0; i < 1000; ++i) json += "{\"id\":" + std::to_string(i) + "},";
+    size_t offset = json.size() + 8;
+    json += "{\"id\":01}]";
+    value = Value::fromJson(json, error);
+    CHECK(error && error.offset == offset && std::strcmp(error.reason, "leading zero in number") == 0);
+
+    // reporting to a handler finds the same errors at the same offsets
+    const std::vector<std::string> invalid = { "", "[1,2", "{\"a\" 1}", "[1 2]", "\"a\x01\"", "01", "[\"\\q\"]", "{} {}", json };
+    for (auto &document : invalid)
+    {
+        JsonError parsed, reported;
+        Value::fromJson(document, parsed);
+        JsonHandler handler;
+        CHECK(!Value::parseJson(document, handler, reported));
+        CHECK(parsed && reported);
+        CHECK(parsed.offset == reported.offset);
+        CHECK(parsed.reason && reported.reason && std::strcmp(parsed.reason, reported.reason) == 0);
+    }
+
+    // a handler that stops the parser is not an error, even when the rest of the document is invalid
+    Stopper stopper;
+    CHECK(Value::parseJson("{\"a\":1,\"stop\":2,@", stopper, error));
+    CHECK(!error);
+
+    // but an error before it stops is
+    CHECK(!Value::parseJson("{\"a\":@,\"stop\":2}", stopper, error));
+    CHECK(error && error.offset == 5);
+
+    // done
+    return report("JsonErrors");
+}
@@ -0,0 +1,136 @@
+/**
+ *  JsonHandler.cpp
+ *
+ *  Reporting documents to a handler, which decides per object member
+ *  and array item whether it is visited, skipped, captured as a value,
+ *  or whether the parser stops
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/JsonHandler.h"
+#include "Check.h"
+#include <functional>
+#include <string>
+
+using namespace Variant;
+
+/**
+ *  Handler that writes down the events, and asks callbacks what to do
+ */
+class Recorder : public JsonHandler
+{
+public:
+    /**
+     *  The events that were reported
+     *  @var    std::string
+     */
+    std::string log;
+
+    /**
+     *  What to do with members and items, everything is visited by default
+     */
+    std::function<JsonAction(std::string_view)> key = [](std::string_view) { return JsonVisit; };
+    std::function<JsonAction(size_t)> item = [](size_t) { return JsonVisit; };
+
+    /**
+     *  Whether to go on after a captured value
+     *  @var    bool
+     */
+    bool proceed = true;
+
+    virtual bool onNull() override { log += "null "; return true; }
+    virtual bool onBool(bool value) override { log += value ? "true " : "false "; return true; }
+    virtual bool onInteger(int64_t value) override { log += std::to_string(value) + " "; return true; }
+    virtual bool onDouble(double value) override { log += "d" + std::to_string(value).substr(0, 3) + " "; return true; }
+    virtual bool onString(std::string_view value) override { log += "'" + std::string(value) + "' "; return true; }
+    virtual bool onStartObject() override { log += "{ "; return true; }
+    virtual bool onEndObject() override { log += "} "; return true; }
+    virtual bool onStartArray() override { log += "[ "; return true; }
+    virtual bool onEndArray() override { log += "] "; return true; }
+
+    virtual JsonAction onKey(std::string_view key) override
+    {
+        log += std::string(key) + ": ";
+        return this->key(key);
+    }
+
+    virtual JsonAction onItem(size_t index) override
+    {
+        log += "#" + std::to_string(index) + " ";
+        return item(index);
+    }
+
+    virtual bool onValue(Value&& value) override
+    {
+        log += "=" + value.toJsonString() + " ";
+        return proceed;
+    }
+};
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // everything is reported when the handler visits all elements
+    std::string json = R"({"a":[1,2.5,"x",true,null],"b":{"c":[[],[7]]}})";
+    Recorder all;
+    CHECK(Value::parseJson(json, all));
+    CHECK(all.log == "{ a: [ #0 1 #1 d2.5 #2 'x' #3 true #4 null ] b: { c: [ #0 [ ] #1 [ #0 7 ] ] } } ");
+
+    // skipped items are not reported, whatever they hold, and the indices go on
+    Recorder skip;
+    skip.item = [](size_t index) { return index % 2 ? JsonSkip : JsonVisit; };
+    CHECK(Value::parseJson(R"([0,{"a":[1,2]},2,[3,[4]],4])", skip));
+    CHECK(skip.log == "[ #0 0 #1 #2 2 #3 #4 4 ] ");
+
+    // captured items are passed as a value, also when they are containers
+    Recorder capture;
+    capture.item = [](size_t index) { return index == 1 ? JsonCapture : JsonVisit; };
+    CHECK(Value::parseJson(R"([[1],{"a":[1,"two"],"b":null},"x"])", capture));
+    CHECK(capture.log == R"([ #0 [ #0 1 ] #1 ={"a":[1,"two"],"b":null} #2 'x' ] )");
+
+    // the parser stops at the item, and the rest of the document is not looked at
+    Recorder stop;
+    stop.item = [](size_t index) { return index == 2 ? JsonStop : JsonVisit; };
+    CHECK(Value::parseJson("[0,1,2,3", stop));
+    CHECK(stop.log == "[ #0 0 #1 1 #2 ");
+
+    // also when it stops inside a nested array
+    Recorder nested;
+    nested.item = [](size_t index) { return index == 1 ? JsonStop : JsonVisit; };
+    CHECK(Value::parseJson(R"({"list":[5,6],"more":@})", nested));
+    CHECK(nested.log == "{ list: [ #0 5 #1 ");
+
+    // the same actions for object members
+    Recorder members;
+    members.key = [](std::string_view key) { return key == "skip" ? JsonSkip : key == "capture" ? JsonCapture : key == "stop" ? JsonStop : JsonVisit; };
+    CHECK(Value::parseJson(R"({"a":1,"skip":{"x":[1,2]},"capture":[true,{"y":2}],"b":"c","stop":3,"after":@})", members));
+    CHECK(members.log == R"({ a: 1 skip: capture: =[true,{"y":2}] b: 'c' stop: )");
+
+    // a handler that does not want more values after a capture stops the parser too
+    Recorder enough;
+    enough.key = [](std::string_view) { return JsonCapture; };
+    enough.proceed = false;
+    CHECK(Value::parseJson(R"({"first":{"a":1},"second":2,@)", enough));
+    CHECK(enough.log == R"({ first: ={"a":1} )");
+
+    // captured values are the same as the values that are parsed completely
+    Recorder numbers;
+    numbers.item = [](size_t) { return JsonCapture; };
+    CHECK(Value::parseJson(R"([12345678901,-0.5,"é😀",{}])", numbers));
+    CHECK(numbers.log == "[ #0 =12345678901 #1 =-0.5 #2 =\"é\U0001F600\" #3 ={} ] ");
+
+    // elements that are skipped or captured must still be valid
+    JsonError error;
+    Recorder invalid;
+    invalid.item = [](size_t index) { return index == 0 ? JsonSkip : JsonCapture; };
+    CHECK(!Value::parseJson("[[1,],2]", invalid, error) && error && error.offset == 4);
+    CHECK(!Value::parseJson("[1,{\"a\" 1}]", invalid, error) && error && error.offset == 8);
+    CHECK(!Value::parseJson("[1,2", invalid, error) && error);
+
+    // done
+    return report("JsonHandler");
+}
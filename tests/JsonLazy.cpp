@@ -0,0 +1,90 @@
+/**
+ *  JsonLazy.cpp
+ *
+ *  Json documents that are decoded on demand: round trips of the
+ *  original text, modifications, and truncated or invalid input
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Check.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // a document with whitespace that fromJson() would not write back
+    const std::string json = "{ \"id\" : 7, \"payload\" : { \"list\" : [ 1, 2.5, \"x\" ], \"empty\" : { } }, \"tags\" : [ [ ], [ true ] ] }";
+
+    // an untouched document is written back exactly
+    JsonError error;
+    Value lazy = Value::fromJsonLazy(json, error);
+    CHECK(!error);
+    CHECK(lazy.toJsonString() == json);
+
+    // and it is equal to the decoded document, with the same hash
+    Value decoded = Value::fromJson(json);
+    CHECK(lazy == decoded && decoded == lazy);
+    CHECK(lazy.hash() == decoded.hash());
+
+    // reading members does not change what is written
+    const Value &constant = lazy;
+    CHECK((int)constant["id"] == 7);
+    CHECK(constant["payload"]["list"].size() == 3);
+    CHECK(lazy.toJsonString() == json);
+
+    // an untouched nested container is still copied from the original text
+    lazy["id"] = (int64_t)8;
+    CHECK(lazy.toJsonString() == "{\"id\":8,\"payload\":{ \"list\" : [ 1, 2.5, \"x\" ], \"empty\" : { } },\"tags\":[ [ ], [ true ] ]}");
+
+    // a modified nested container is written like any other value
+    lazy["payload"]["list"][0] = "one";
+    CHECK(lazy.toJsonString() == "{\"id\":8,\"payload\":{\"list\":[\"one\",2.5,\"x\"],\"empty\":{ }},\"tags\":[ [ ], [ true ] ]}");
+
+    // the modified document parses to the same value
+    CHECK(Value::fromJson(lazy.toJsonString()) == lazy);
+
+    // copies of a lazy document do not see each other's modifications
+    Value original = Value::fromJsonLazy(json);
+    Value copy = original;
+    copy["tags"][1][0] = false;
+    CHECK(original.toJsonString() == json);
+    CHECK(copy != original);
+
+    // scalar documents are decoded right away
+    CHECK(Value::fromJsonLazy(" 12 ").type() == ValueInt64Type);
+    CHECK(Value::fromJsonLazy("\"text\"").view() == "text");
+
+    // every proper prefix of the document is rejected, at the same offset as fromJson() rejects it
+    for (size_t size = 0; size < json.size(); ++size)
+    {
+        JsonError lazyError, eagerError;
+        Value result = Value::fromJsonLazy(json.substr(0, size), lazyError);
+        Value::fromJson(json.substr(0, size), eagerError);
+        CHECK(lazyError && result.type() == ValueNullType);
+        CHECK(lazyError.offset == eagerError.offset);
+    }
+
+    // invalid documents are rejected before anything is decoded
+    const std::vector<std::string> invalid = { "{\"a\":[1,2}", "[{\"deep\":[01]}]", "[\"\\u12\"]", "[\"a\x1f\"]", "{\"a\":1}x" };
+    for (auto &document : invalid)
+    {
+        JsonError lazyError, eagerError;
+        Value::fromJsonLazy(document, lazyError);
+        Value::fromJson(document, eagerError);
+        CHECK(lazyError && eagerError);
+        CHECK(lazyError.offset == eagerError.offset);
+        CHECK(lazyError.reason && eagerError.reason && std::strcmp(lazyError.reason, eagerError.reason) == 0);
+    }
+
+    // done
+    return report("JsonLazy");
+}
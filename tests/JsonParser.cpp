@@ -0,0 +1,152 @@
+/**
+ *  JsonParser.cpp
+ *
+ *  Round trips, truncated input and invalid input for the json parser
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Check.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Documents that are written back exactly as they were parsed
+ */
+static const std::vector<std::string> documents = {
+    "null",
+    "true",
+    "false",
+    "0",
+    "-12",
+    "9223372036854775807",
+    "-9223372036854775808",
+    "1.5",
+    "-0.25",
+    "1e+300",
+    "\"\"",
+    "\"text\"",
+    "\"quote \\\" backslash \\\\ newline \\n tab \\t\"",
+    "\"\\u0001\\u001f\"",
+    "\"\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\"",
+    "[]",
+    "{}",
+    "[1,2.5,\"three\",true,null,[],{}]",
+    "{\"a\":{\"b\":{\"c\":[1,{\"d\":\"e\"}]}},\"f\":[[[]]]}",
+    "{\"z\":1,\"a\":2,\"m\":3}",
+};
+
+/**
+ *  Parse a document that must be valid
+ *
+ *  @param  json
+ *  @return Value
+ */
+static Value parse(const std::string& json)
+{
+    JsonError error;
+    Value result = Value::fromJson(json, error);
+    CHECK(!error);
+    return result;
+}
+
+/**
+ *  Check that a document is rejected
+ *
+ *  @param  json
+ *  @param  reason      the expected reason, or a nullptr for any reason
+ *  @param  offset      the expected offset
+ */
+static void reject(const std::string& json, const char *reason, size_t offset)
+{
+    JsonError error;
+    Value result = Value::fromJson(json, error);
+    CHECK(error);
+    CHECK(result.type() == ValueNullType);
+    if (!error) return;
+    CHECK(reason == nullptr || std::string(error.reason) == reason);
+    CHECK(error.offset == offset);
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // documents are written back exactly, and parse to the same value again
+    for (auto &json : documents)
+    {
+        Value value = parse(json);
+        CHECK(value.toJsonString() == json);
+        CHECK(parse(value.toJsonString()) == value);
+    }
+
+    // whitespace around and inside the document is ignored
+    CHECK(parse(" \t\r\n{ \"a\" : [ 1 , 2 ] }\n") == parse("{\"a\":[1,2]}"));
+
+    // integers that fit are integers, larger numbers are doubles
+    CHECK(parse("123").type() == ValueInt64Type);
+    CHECK(parse("9223372036854775808").type() == ValueDoubleType);
+    CHECK(parse("1.0").type() == ValueDoubleType);
+    CHECK(std::isinf((double)parse("1e999")));
+
+    // escape sequences, and surrogate pairs
+    CHECK(parse("\"\\/\\b\\f\\r\"").view() == "/\b\f\r");
+    CHECK(parse("\"\\u00e9\"").view() == "\xc3\xa9");
+    CHECK(parse("\"\\ud83d\\ude00\"").view() == "\xf0\x9f\x98\x80");
+
+    // a surrogate without its partner becomes a replacement character, and the next escape is kept
+    CHECK(parse("\"\\ud800\\u0041\"").view() == "\xef\xbf\xbd" "A");
+    CHECK(parse("\"\\ud800x\"").view() == "\xef\xbf\xbdx");
+    CHECK(parse("\"\\udc00\"").view() == "\xef\xbf\xbd");
+    CHECK(parse("\"\\ud800\\ud800\\udc00\"").view() == "\xef\xbf\xbd\xf0\x90\x80\x80");
+
+    // the members of an object keep their order, a duplicate key keeps the last value
+    CHECK(parse("{\"b\":1,\"a\":2,\"b\":3}").toJsonString() == "{\"b\":3,\"a\":2}");
+
+    // every proper prefix of a container or string is incomplete
+    for (auto &json : documents)
+    {
+        // scalars like numbers are complete after every digit
+        if (json[0] != '[' && json[0] != '{' && json[0] != '"') continue;
+        for (size_t size = 0; size < json.size(); ++size)
+        {
+            JsonError error;
+            Value::fromJson(json.substr(0, size), error);
+            CHECK(error);
+            CHECK(error.offset <= size);
+        }
+    }
+
+    // invalid documents, with the offset of the error
+    reject("", "unexpected end of input", 0);
+    reject("[1,2", "unexpected end of input", 4);
+    reject("{\"a\"", "unexpected end of input", 4);
+    reject("\"abc", "unterminated string", 4);
+    reject("@", "unexpected character", 0);
+    reject("[1 2]", "expected ',' or ']'", 3);
+    reject("{\"a\":1 \"b\":2}", "expected ',' or '}'", 7);
+    reject("{\"a\" 1}", "expected ':'", 5);
+    reject("{1:2}", "expected string as object key", 1);
+    reject("[1,]", nullptr, 3);
+    reject("tru", "invalid literal", 0);
+    reject("nul", "invalid literal", 0);
+    reject("-", "invalid number", 1);
+    reject("1.", "invalid number", 2);
+    reject("1e", "invalid number", 2);
+    reject("01", "leading zero in number", 2);
+    reject("-012", "leading zero in number", 4);
+    reject("\"a\tb\"", "control character in string", 2);
+    reject("\"\\x\"", "invalid escape sequence", 2);
+    reject("\"\\u12\"", "invalid unicode escape", 3);
+    reject("1 2", "unexpected data after value", 2);
+    reject(std::string(2000, '['), "nesting too deep", 1024);
+
+    // done
+    return report("JsonParser");
+}
@@ -0,0 +1,88 @@
+/**
+ *  JsonStream.cpp
+ *
+ *  Streams of json documents, fed in chunks of every size, with
+ *  truncated and invalid documents
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "../include/JsonStream.h"
+#include "Check.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Feed input to a new stream in chunks of the same size
+ *
+ *  @param  input       the input
+ *  @param  chunk       size of the chunks
+ *  @param  documents   the documents that were found, as json
+ *  @return was the input valid and complete?
+ */
+static bool feed(const std::string& input, size_t chunk, std::vector<std::string>& documents)
+{
+    // collect the documents
+    JsonStream stream([&documents](Value&& value) { documents.push_back(value.toJsonString()); });
+
+    // feed the chunks, and signal the end
+    bool valid = true;
+    for (size_t offset = 0; offset < input.size(); offset += chunk) valid = stream.parse(input.data() + offset, std::min(chunk, input.size() - offset)) && valid;
+    return stream.finish() && valid;
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // documents of every type, with and without separating whitespace
+    std::string input = "{\"a\":1,\"s\":\"x}\\\"y\"}\n[1,[2,3]]\n  \"str\\\"ing\" 42 true null -1.5e3{\"b\":{}}[]\n\"\\u00e9\"\n7";
+    const std::vector<std::string> expected = { "{\"a\":1,\"s\":\"x}\\\"y\"}", "[1,[2,3]]", "\"str\\\"ing\"", "42", "true", "null", "-1500.0", "{\"b\":{}}", "[]", "\"\xc3\xa9\"", "7" };
+
+    // the same documents come out, no matter how the input is split up
+    for (size_t chunk = 1; chunk <= input.size(); ++chunk)
+    {
+        std::vector<std::string> documents;
+        CHECK(feed(input, chunk, documents));
+        CHECK(documents == expected);
+    }
+
+    // the documents are parsed just like fromJson() parses them
+    for (auto &json : expected) CHECK(Value::fromJson(json).toJsonString() == json);
+
+    // a truncated document is reported at the end of the input, the complete ones before it are not lost
+    for (size_t size = 1; size < 10; ++size)
+    {
+        std::vector<std::string> documents;
+        CHECK(!feed("[1]\n{\"a\":[1,2]}\n" + std::string("{\"b\":\"cd\"}").substr(0, size), 3, documents));
+        CHECK(documents.size() == 2);
+    }
+
+    // an invalid document is skipped, and the stream goes on with the next one
+    std::vector<std::string> documents;
+    JsonStream stream([&documents](Value&& value) { documents.push_back(value.toJsonString()); });
+    CHECK(!stream.parse("{\"a\":}\n{\"b\":2}\n", 15));
+    CHECK(stream.error() && stream.error().offset == 5);
+    CHECK(documents.size() == 1 && documents[0] == "{\"b\":2}");
+
+    // errors are counted from the start of the stream, and the parser rejects what the stream lets through
+    CHECK(!stream.parse("01\n", 3));
+    CHECK(stream.error() && stream.error().offset == 17);
+    CHECK(stream.parse("12", 2));
+    CHECK(stream.finish());
+    CHECK(documents.size() == 2 && documents[1] == "12");
+
+    // an unclosed container at the end of the input
+    CHECK(stream.parse("[1,", 3));
+    CHECK(!stream.finish());
+    CHECK(stream.error() && stream.error().offset == 23);
+
+    // done
+    return report("JsonStream");
+}
@@ -0,0 +1,96 @@
+/**
+ *  KeyTable.cpp
+ *
+ *  Interning keys, and maps that share their long keys through the
+ *  table while it is enabled
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/KeyTable.h"
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Check.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  The data of the first key of a map
+ *  @param  map
+ *  @return const char *
+ */
+static const char *first(const Value& map)
+{
+    return map.begin()->key().data();
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // keys are not shared until the table is enabled
+    const std::string name = "a field name that is too long to be stored inline";
+    CHECK(KeyTable::intern(name) == nullptr);
+    Value before = Value::fromJson("{\"" + name + "\":1}");
+    CHECK(first(before) != nullptr && KeyTable::intern(name) == nullptr);
+
+    // the same key is interned once, and stays valid when the original is gone
+    KeyTable::enable(4);
+    const char *interned = KeyTable::intern(name);
+    CHECK(interned != nullptr && interned != name.data());
+    CHECK(std::string_view(interned, name.size()) == name);
+    CHECK(KeyTable::intern(std::string(name)) == interned);
+    CHECK(KeyTable::intern("another key") != interned);
+    CHECK(KeyTable::intern(std::string_view(name).substr(0, 10)) != interned);
+
+    // keys are no longer added when the table is full, but the ones it holds are still found
+    CHECK(KeyTable::intern("a fourth key") != nullptr);
+    CHECK(KeyTable::intern("one key too many") == nullptr);
+    CHECK(KeyTable::intern(name) == interned);
+    KeyTable::enable();
+    CHECK(KeyTable::intern("one key too many") != nullptr);
+
+    // maps share long keys through the table, short keys are stored in the map
+    Value parsed = Value::fromJson("{\"" + name + "\":1,\"id\":2}");
+    Value built;
+    built[name] = 3;
+    CHECK(first(parsed) == interned && first(built) == interned);
+    CHECK(first(before) != interned);
+    Value small = Value::fromJson(R"({"id":1})");
+    CHECK(KeyTable::intern("id") != first(small));
+
+    // maps with shared keys work like all other maps
+    const Value &constant = parsed;
+    CHECK(constant[name] == Value((int64_t)1) && constant["id"] == Value((int64_t)2));
+    CHECK(constant.find(name.c_str()) != nullptr && constant.find(name + "x") == nullptr);
+    CHECK(parsed.toJsonString() == "{\"" + name + "\":1,\"id\":2}");
+    Value copy = parsed;
+    copy[name] = 4;
+    CHECK(first(copy) == interned && constant[name] == Value((int64_t)1));
+    CHECK(Value::fromMsgPack(parsed.toMsgPack()) == parsed);
+    CHECK(before == Value::fromJson("{\"" + name + "\":1}") && before.hash() == Value::fromJson("{\"" + name + "\":1}").hash());
+
+    // keys that are added by several threads at the same time are interned once
+    std::vector<const char *> results(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < results.size(); ++t) threads.emplace_back([&results, t]() {
+        for (int i = 0; i < 1000; ++i) KeyTable::intern("concurrent key number " + std::to_string(i));
+        results[t] = KeyTable::intern("concurrent key number 500");
+    });
+    for (auto &thread : threads) thread.join();
+    for (auto result : results) CHECK(result != nullptr && result == results[0]);
+
+    // after the table is disabled keys are stored in the map again, the interned keys stay valid
+    KeyTable::disable();
+    CHECK(KeyTable::intern(name) == nullptr);
+    Value after = Value::fromJson("{\"" + name + "\":1}");
+    CHECK(first(after) != interned && after == before);
+    CHECK(first(parsed) == interned && std::string_view(interned, name.size()) == name);
+
+    // done
+    return report("KeyTable");
+}
@@ -0,0 +1,129 @@
+/**
+ *  MsgPack.cpp
+ *
+ *  Round trips, encodings of other writers, truncated input and
+ *  invalid input for MessagePack
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Check.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Parse data that must be valid
+ *
+ *  @param  data
+ *  @return Value
+ */
+static Value parse(const std::string& data)
+{
+    JsonError error;
+    Value result = Value::fromMsgPack(data, error);
+    CHECK(!error);
+    return result;
+}
+
+/**
+ *  Check that data is rejected
+ *
+ *  @param  data
+ *  @param  reason      the expected reason
+ *  @param  offset      the expected offset
+ */
+static void reject(const std::string& data, const char *reason, size_t offset)
+{
+    JsonError error;
+    Value result = Value::fromMsgPack(data, error);
+    CHECK(error && result.type() == ValueNullType);
+    if (!error) return;
+    CHECK(std::strcmp(error.reason, reason) == 0);
+    CHECK(error.offset == offset);
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // a document with every type, and every size of header
+    Value document;
+    document["null"] = nullptr;
+    document["bool"] = true;
+    document["int32"] = (int32_t)-100000;
+    document["small"] = (int32_t)7;
+    document["int64"] = (int64_t)7;
+    document["double"] = 7.0;
+    document["strings"] = std::vector<Value>{ "", "short", std::string(31, 's'), std::string(32, 'm'), std::string(300, 'l'), std::string(70000, 'x') };
+    for (int i = 0; i < 70000; ++i) document["long"][i] = i;
+    for (int i = 0; i < 20; ++i) document["map"][std::to_string(i)] = std::vector<Value>{ i };
+
+    // the round trip gives the same value with the same types, and the same bytes
+    std::string data = document.toMsgPack();
+    Value copy = parse(data);
+    CHECK(copy == document);
+    CHECK(copy.hash() == document.hash());
+    CHECK(copy.toMsgPack() == data);
+    const Value &constant = copy;
+    CHECK(constant["int32"].type() == ValueInt32Type);
+    CHECK(constant["int64"].type() == ValueInt64Type);
+    CHECK(constant["double"].type() == ValueDoubleType);
+
+    // appending to a buffer
+    std::string buffer = "prefix";
+    document.toMsgPack(buffer);
+    CHECK(buffer == "prefix" + data);
+
+    // the most compact encodings
+    CHECK(Value(nullptr).toMsgPack() == std::string("\xc0", 1));
+    CHECK(Value(false).toMsgPack() == "\xc2");
+    CHECK(Value(1).toMsgPack() == "\x01");
+    CHECK(Value(-1).toMsgPack() == "\xff");
+    CHECK(Value(-100).toMsgPack() == "\xd0\x9c");
+    CHECK(Value(1000).toMsgPack() == std::string("\xd1\x03\xe8", 3));
+    CHECK(Value((int64_t)1).toMsgPack() == std::string("\xd3\x00\x00\x00\x00\x00\x00\x00\x01", 9));
+    CHECK(Value("abc").toMsgPack() == "\xa3" "abc");
+    CHECK(Value(std::vector<Value>()).toMsgPack() == "\x90");
+    CHECK(Value(std::map<std::string, Value>()).toMsgPack() == "\x80");
+
+    // encodings that other writers use
+    CHECK(parse("\xcc\xff") == Value(255));
+    CHECK(parse("\xcd\xff\xff") == Value(65535));
+    CHECK(parse("\xce\xff\xff\xff\xff") == Value((int64_t)4294967295));
+    CHECK(parse("\xcf\x7f\xff\xff\xff\xff\xff\xff\xff") == Value((int64_t)INT64_MAX));
+    CHECK(parse("\xcf\xff\xff\xff\xff\xff\xff\xff\xff").type() == ValueDoubleType);
+    CHECK(parse(std::string("\xca\x3f\xc0\x00\x00", 5)) == Value(1.5));
+    CHECK(parse(std::string("\xc4\x02\x00\x01", 4)).view() == std::string("\x00\x01", 2));
+    CHECK(parse(std::string("\xdc\x00\x01\xc3", 4)) == Value(std::vector<Value>{ true }));
+    CHECK(parse(std::string("\x81\xc4\x01k\x01", 5)) == Value(std::map<std::string, Value>{ { "k", 1 } }));
+
+    // every proper prefix is incomplete
+    std::string sample = Value::fromJson("{\"a\":[1,-1.5,\"text\",null,true],\"b\":{\"c\":\"d\"},\"e\":9223372036854775807}").toMsgPack();
+    for (size_t size = 0; size < sample.size(); ++size)
+    {
+        JsonError error;
+        Value::fromMsgPack(sample.substr(0, size), error);
+        CHECK(error && std::strcmp(error.reason, "unexpected end of input") == 0);
+        CHECK(error.offset <= size);
+    }
+
+    // invalid input
+    reject("", "unexpected end of input", 0);
+    reject("\xa5" "abc", "unexpected end of input", 1);
+    reject("\xdd\xff\xff\xff\xff", "unexpected end of input", 5);
+    reject("\x81\x01\x01", "map key is not a string", 1);
+    reject("\xc1", "unsupported type", 0);
+    reject("\xd4\x01\x02", "unsupported type", 0);
+    reject("\xc0\xc0", "unexpected data after value", 1);
+    reject(std::string(2000, '\x91'), "nesting too deep", 1025);
+
+    // done
+    return report("MsgPack");
+}
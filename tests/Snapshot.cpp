@@ -0,0 +1,158 @@
+/**
+ *  Snapshot.cpp
+ *
+ *  Round trips, modifications, mapped files, and truncated or
+ *  invalid data for binary snapshots
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Check.h"
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace Variant;
+
+/**
+ *  Copy data to memory that is aligned to eight bytes, plus a number of bytes
+ *
+ *  @param  data        the data to copy
+ *  @param  shift       number of bytes after the aligned address
+ *  @param  buffer      memory to copy the data to
+ *  @return the copied data
+ */
+static std::string_view aligned(const std::string& data, size_t shift, std::vector<uint64_t>& buffer)
+{
+    buffer.assign((data.size() + shift) / sizeof(uint64_t) + 1, 0);
+    char *start = reinterpret_cast<char *>(buffer.data()) + shift;
+    std::memcpy(start, data.data(), data.size());
+    return std::string_view(start, data.size());
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // a document with every type
+    Value document;
+    document["null"] = nullptr;
+    document["bool"] = true;
+    document["int32"] = (int32_t)-100000;
+    document["int64"] = (int64_t)1 << 40;
+    document["double"] = -1.5;
+    document["string"] = "text";
+    document["empty"] = std::vector<Value>();
+    for (int i = 0; i < 1000; ++i) document["list"][i] = i % 3 ? Value(i) : Value("item" + std::to_string(i));
+    for (int i = 0; i < 100; ++i) document["map"][std::to_string(i)]["name"] = "text";
+
+    // the round trip gives the same value, that is written the same way in every format
+    std::string data = document.toSnapshot();
+    std::vector<uint64_t> buffer;
+    Value snapshot = Value::fromSnapshot(aligned(data, 0, buffer));
+    CHECK(snapshot == document && document == snapshot);
+    CHECK(snapshot.hash() == document.hash());
+    CHECK(snapshot.toJsonString() == document.toJsonString());
+    CHECK(snapshot.toMsgPack() == document.toMsgPack());
+    CHECK(snapshot.toCbor() == document.toCbor());
+    CHECK(snapshot.toSnapshot() == data);
+
+    // members keep their types, and strings refer to the snapshot
+    const Value &constant = snapshot;
+    CHECK(constant["int32"].type() == ValueInt32Type);
+    CHECK(constant["int64"].type() == ValueInt64Type);
+    CHECK(constant["list"][3].view() == "item3");
+    CHECK(constant["list"][998] == Value(998));
+    CHECK(constant["missing"].type() == ValueNullType);
+    std::string_view text = constant["string"].view();
+    const char *start = reinterpret_cast<const char *>(buffer.data());
+    CHECK(text.data() >= start && text.data() + text.size() <= start + data.size());
+
+    // containers can be converted
+    std::vector<Value> list = constant["list"];
+    CHECK(list.size() == 1000 && list[1] == Value(1));
+    std::map<std::string, Value> map = constant["map"];
+    CHECK(map.size() == 100 && map["42"] == document["map"]["42"]);
+
+    // a modification goes to a copy, the snapshot and other values taken from it are left alone
+    Value modified = snapshot;
+    modified["list"][1] = "one";
+    modified["added"] = 1;
+    CHECK(modified["list"][1].view() == "one");
+    CHECK(constant["list"][1] == Value(1));
+    CHECK(snapshot == document && modified != document);
+    CHECK(Value::fromJson(modified.toJsonString()).toJsonString() == modified.toJsonString());
+
+    // a snapshot that is written to a file is mapped into memory
+    char filename[] = "/tmp/snapshotXXXXXX";
+    int fd = mkstemp(filename);
+    CHECK(fd >= 0 && write(fd, data.data(), data.size()) == (ssize_t)data.size());
+    close(fd);
+    Value mapped = Value::fromSnapshotFile(filename);
+    unlink(filename);
+    CHECK(mapped == document);
+    CHECK(Value::fromSnapshotFile(filename).type() == ValueNullType);
+
+    // scalar snapshots, other data is copied to a buffer of its own because the snapshot still uses the first one
+    std::vector<uint64_t> scratch;
+    CHECK(Value::fromSnapshot(aligned(Value(7).toSnapshot(), 0, scratch)) == Value(7));
+    CHECK(Value::fromSnapshot(aligned(Value("x").toSnapshot(), 0, scratch)).view() == "x");
+
+    // data that is not aligned is not read
+    CHECK(Value::fromSnapshot(aligned(data, 1, scratch)).type() == ValueNullType);
+    CHECK(Value::fromSnapshot(aligned(data, 4, scratch)).type() == ValueNullType);
+
+    // neither is data without the header
+    CHECK(Value::fromSnapshot(aligned(std::string(64, 'x'), 0, scratch)).type() == ValueNullType);
+    CHECK(Value::fromSnapshot(aligned(document.toJsonString(), 0, scratch)).type() == ValueNullType);
+
+    // a truncated snapshot never gives the original value, and everything that refers past its end is null
+    std::string sample = Value::fromJson("{\"a\":[1,-1.5,\"text\",null,true],\"b\":{\"c\":\"d\"},\"e\":9223372036854775807}").toSnapshot();
+    std::vector<uint64_t> complete;
+    Value original = Value::fromSnapshot(aligned(sample, 0, complete));
+    for (size_t size = 0; size < sample.size(); ++size)
+    {
+        Value truncated = Value::fromSnapshot(aligned(sample.substr(0, size), 0, scratch));
+        CHECK(truncated != original);
+        truncated.toJsonString();
+        truncated.toSnapshot();
+    }
+
+    // damaged snapshots can be read without going outside the data
+    for (size_t position = 16; position < sample.size(); ++position)
+    {
+        std::string damaged = sample;
+        damaged[position] = '\xff';
+        Value value = Value::fromSnapshot(aligned(damaged, 0, scratch));
+        value.toJsonString();
+        value.hash();
+    }
+
+    // a damaged snapshot in which an array holds itself, the header is followed by the root slot, and the
+    // offset of the data is stored in the last eight bytes of every slot
+    std::string cyclic = Value(std::vector<Value>{ std::vector<Value>{ 1 } }).toSnapshot();
+    uint64_t outer;
+    std::memcpy(&outer, &cyclic[16 + 8], sizeof(outer));
+    std::memcpy(&cyclic[outer + 8], &outer, sizeof(outer));
+    Value holder = Value::fromSnapshot(aligned(cyclic, 0, scratch));
+    CHECK(holder.size() == 1 && static_cast<const Value&>(holder)[0].type() == ValueNullType);
+    CHECK(holder.toJsonString() == "[null]");
+
+    // the same for a map that holds itself, every member is a slot for the key and a slot for the value
+    cyclic = Value::fromJson("{\"a\":{\"b\":1}}").toSnapshot();
+    std::memcpy(&outer, &cyclic[16 + 8], sizeof(outer));
+    std::memcpy(&cyclic[outer + 16 + 8], &outer, sizeof(outer));
+    holder = Value::fromSnapshot(aligned(cyclic, 0, scratch));
+    CHECK(holder.toJsonString() == "{\"a\":null}");
+    holder.hash();
+    CHECK(holder != Value::fromJson("{\"a\":{\"b\":1}}"));
+
+    // done
+    return report("Snapshot");
+}
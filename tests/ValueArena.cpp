@@ -0,0 +1,188 @@
+/**
+ *  ValueArena.cpp
+ *
+ *  Values that are created while an arena is active get their memory
+ *  from it, give it back when they are destructed, and copies that
+ *  are made later stay in the arena the value came from
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueArena.h"
+#include "../include/ValueMember.h"
+#include "Check.h"
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  A memory resource that counts what is allocated from it
+ */
+class Counter : public std::pmr::memory_resource
+{
+public:
+    /**
+     *  The number of allocations, and of the ones that were not deallocated
+     *  @var    size_t
+     */
+    size_t allocations = 0;
+    size_t live = 0;
+
+private:
+    /**
+     *  Allocate memory from the heap
+     *  @param  size
+     *  @param  alignment
+     *  @return void*
+     */
+    void *do_allocate(size_t size, size_t alignment) override
+    {
+        ++allocations;
+        ++live;
+        return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+
+    /**
+     *  Give memory back to the heap
+     *  @param  pointer
+     *  @param  size
+     *  @param  alignment
+     */
+    void do_deallocate(void *pointer, size_t size, size_t alignment) override
+    {
+        --live;
+        std::pmr::new_delete_resource()->deallocate(pointer, size, alignment);
+    }
+
+    /**
+     *  Compare with another resource
+     *  @param  that
+     *  @return bool
+     */
+    bool do_is_equal(const std::pmr::memory_resource &that) const noexcept override
+    {
+        return this == &that;
+    }
+};
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // without an arena the heap is used
+    CHECK(ValueArena::active() == nullptr);
+    CHECK(ValueArena::resource() == std::pmr::get_default_resource());
+
+    // values that are created in an arena get their memory from it, scalars do not need any
+    Counter counter;
+    Value kept;
+    {
+        ValueArena arena(&counter);
+        CHECK(ValueArena::active() == &counter && ValueArena::resource() == &counter);
+
+        Value scalar = 1.5;
+        CHECK(counter.allocations == 0);
+
+        Value text = std::string(100, 'x');
+        CHECK(counter.allocations == 2 && counter.live == 2);
+
+        Value document = Value::fromJson(R"({"name":"a string that does not fit in the value itself","list":[1,2,3],"map":{"a":true}})");
+        CHECK(counter.allocations > 2);
+        kept = document;
+    }
+
+    // the arena is no longer active, values that are destructed later still give their memory back
+    CHECK(ValueArena::active() == nullptr);
+    CHECK(counter.live > 0);
+    kept = Value();
+    CHECK(counter.live == 0);
+
+    // nested arenas restore the one that was active before, also when it was the heap
+    Counter outer, inner;
+    {
+        ValueArena first(&outer);
+        {
+            ValueArena second(&inner);
+            Value value = std::vector<Value>{ 1 };
+            CHECK(inner.allocations > 0 && outer.allocations == 0);
+            {
+                ValueArena heap(nullptr);
+                CHECK(ValueArena::active() == nullptr);
+                Value heapValue = std::vector<Value>{ 1 };
+            }
+            CHECK(ValueArena::active() == &inner);
+        }
+        CHECK(ValueArena::active() == &outer);
+        Value value = std::vector<Value>{ 1 };
+        CHECK(outer.allocations > 0);
+    }
+    CHECK(ValueArena::active() == nullptr);
+    CHECK(inner.live == 0 && outer.live == 0);
+
+    // a copy that is modified after the arena is gone is made in the same arena, and leaves the original alone
+    Counter shared;
+    Value original;
+    {
+        ValueArena arena(&shared);
+        original["a"] = 1;
+        original["list"][0] = "x";
+    }
+    Value copy = original;
+    size_t before = shared.allocations;
+    copy["a"] = 2;
+    copy["list"][0] = "y";
+    CHECK(shared.allocations > before);
+    CHECK(original.toJsonString() == R"({"a":1,"list":["x"]})");
+    CHECK(copy.toJsonString() == R"({"a":2,"list":["y"]})");
+
+    // new values that are created after the arena is gone are on the heap
+    before = shared.allocations;
+    Value later = std::vector<Value>{ original };
+    CHECK(shared.allocations == before);
+    original = Value();
+    copy = Value();
+    later = Value();
+    CHECK(shared.live == 0);
+
+    // the containers of lazy documents are decoded in the arena the document was parsed in
+    Counter lazy;
+    Value document;
+    {
+        ValueArena arena(&lazy);
+        document = Value::fromJsonLazy(R"({"list":[1,2,3],"map":{"a":"b"}})");
+    }
+    before = lazy.allocations;
+    CHECK(static_cast<const Value&>(document)["map"]["a"].view() == "b");
+    CHECK(lazy.allocations > before);
+    document = Value();
+    CHECK(lazy.live == 0);
+
+    // an arena is only active on the thread that created it
+    Counter local;
+    {
+        ValueArena arena(&local);
+        std::thread thread([]() {
+            CHECK(ValueArena::active() == nullptr);
+            Value value = std::vector<Value>{ 1, "two" };
+        });
+        thread.join();
+    }
+    CHECK(local.allocations == 0);
+
+    // values in a monotonic buffer
+    char buffer[4096];
+    {
+        std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        ValueArena arena(&resource);
+        Value value = Value::fromJson(R"({"items":[{"sku":"first product"},{"sku":"second product"}]})");
+        CHECK(static_cast<const Value&>(value)["items"][1]["sku"].view() == "second product");
+    }
+
+    // done
+    return report("ValueArena");
+}
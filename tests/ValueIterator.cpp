@@ -0,0 +1,85 @@
+/**
+ *  ValueIterator.cpp
+ *
+ *  Iterating over the items of vectors and the members of maps, and
+ *  keeping elements after the iterator has moved on
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Check.h"
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Elements are returned by value, so the iterator must not claim to be a forward iterator
+ */
+static_assert(std::is_same<std::iterator_traits<ValueIterator>::iterator_category, std::input_iterator_tag>::value, "input iterator");
+static_assert(std::is_same<std::iterator_traits<ValueIterator>::reference, ValueIterator::Element>::value, "elements by value");
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // the items of a vector, in order and without keys
+    Value list(std::vector<Value>{ 1, "two", 3.0 });
+    std::vector<Value> items;
+    for (const Value &item : list) items.push_back(item);
+    CHECK(items == std::vector<Value>({ 1, "two", 3.0 }));
+    for (const auto &element : list) CHECK(element.key().empty());
+
+    // the members of a map, in insertion order
+    Value map;
+    map["z"] = 1;
+    map["a"] = 2;
+    map["m"] = 3;
+    std::string keys;
+    int64_t sum = 0;
+    for (const auto &member : map)
+    {
+        keys += member.key();
+        sum += (int64_t)member.value();
+    }
+    CHECK(keys == "zam" && sum == 6);
+
+    // the elements refer to the values in the container
+    const Value &constant = map;
+    CHECK(&(*constant.begin()).value() == constant.find("z"));
+    CHECK(&constant.begin()->value() == constant.find("z"));
+
+    // elements stay valid after the iterator has moved on
+    std::vector<ValueIterator::Element> elements;
+    for (auto iterator = map.begin(); iterator != map.end(); ++iterator) elements.push_back(*iterator);
+    CHECK(elements.size() == 3);
+    CHECK(elements[0].key() == "z" && elements[2].key() == "m");
+    CHECK(elements[1].value() == Value(2));
+
+    // also when an element is taken before the iterator is incremented
+    auto iterator = map.begin();
+    auto first = *iterator++;
+    CHECK(first.key() == "z" && iterator->key() == "a");
+
+    // algorithms that only read the elements once work
+    std::vector<Value> copies(list.begin(), list.end());
+    CHECK(copies.size() == 3 && copies[1].view() == "two");
+    CHECK(std::count_if(map.begin(), map.end(), [](const ValueIterator::Element& element) { return (int)element.value() > 1; }) == 2);
+    CHECK(std::distance(map.begin(), map.end()) == 3);
+
+    // scalars, strings and empty containers have no elements
+    CHECK(Value(1).begin() == Value(1).end());
+    Value empty(std::vector<Value>{});
+    CHECK(empty.begin() == empty.end());
+    Value text("text");
+    CHECK(text.begin() == text.end());
+
+    // done
+    return report("ValueIterator");
+}
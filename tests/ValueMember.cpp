@@ -0,0 +1,62 @@
+/**
+ *  ValueMember.cpp
+ *
+ *  Assigning values to members, including values that are part of
+ *  the same document and that move when the member is added
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValueMember.h"
+#include "Check.h"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // a map with members that are stored out of line
+    Value document;
+    for (int i = 0; i < 8; ++i) document["k" + std::to_string(i)] = std::string(40, 'a' + i);
+    const Value &constant = document;
+
+    // adding a member may move the others, the assigned member must still be read correctly
+    document["new"] = constant["k0"];
+    CHECK(constant["new"].view() == std::string(40, 'a'));
+    CHECK(constant["k0"].view() == std::string(40, 'a'));
+    CHECK(document.size() == 9);
+
+    // the same for every member that is added, and for members of members
+    for (int i = 0; i < 100; ++i) document["copy" + std::to_string(i)] = constant["k" + std::to_string(i % 8)];
+    for (int i = 0; i < 100; ++i) CHECK(constant["copy" + std::to_string(i)] == constant["k" + std::to_string(i % 8)]);
+    for (int i = 0; i < 8; ++i) document["nested"]["k" + std::to_string(i)] = constant["k" + std::to_string(i)];
+    for (int i = 0; i < 100; ++i) document["nested"]["copy" + std::to_string(i)] = constant["nested"]["k" + std::to_string(i % 8)];
+    CHECK(constant["nested"]["copy99"].view() == std::string(40, 'd'));
+
+    // and for elements that are added to an array
+    Value list;
+    list[0] = std::string(40, 'x');
+    for (int i = 1; i < 100; ++i) list[i] = static_cast<const Value&>(list)[i - 1];
+    CHECK(static_cast<const Value&>(list)[99].view() == std::string(40, 'x'));
+
+    // a member can be replaced with a member of itself
+    document["tree"]["child"]["leaf"] = 1;
+    document["tree"] = constant["tree"]["child"];
+    CHECK(constant["tree"]["leaf"] == Value(1));
+    CHECK(constant["tree"]["child"].type() == ValueNullType);
+
+    // vectors and maps are assigned too
+    document["vector"] = std::vector<Value>{ 1, "two" };
+    document["map"] = std::map<std::string, Value>{ { "a", 1 } };
+    CHECK(constant["vector"][1].view() == "two");
+    CHECK(constant["map"]["a"] == Value(1));
+
+    // done
+    return report("ValueMember");
+}
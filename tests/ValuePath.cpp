@@ -0,0 +1,148 @@
+/**
+ *  ValuePath.cpp
+ *
+ *  Parsing json pointers and dotted paths, looking them up, and
+ *  adding the members they refer to
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "../include/ValuePath.h"
+#include "Check.h"
+#include <cstring>
+#include <string>
+
+using namespace Variant;
+
+/**
+ *  Look up a path in a document
+ *  @param  document
+ *  @param  path
+ *  @return the value as json, or "missing"
+ */
+static std::string lookup(const Value& document, const char *path)
+{
+    const Value *value = ValuePath(path).find(document);
+    return value ? value->toJsonString() : "missing";
+}
+
+/**
+ *  The reason why a path is invalid, and where
+ *  @param  path
+ *  @param  offset
+ *  @param  reason
+ *  @return did the path fail like that?
+ */
+static bool fails(const char *path, size_t offset, const char *reason)
+{
+    JsonError error;
+    ValuePath parsed(path, error);
+    return !parsed && parsed.size() == 0 && error && error.offset == offset && strcmp(error.reason, reason) == 0;
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // the example document of RFC 6901
+    Value example = Value::fromJson(R"({"foo":["bar","baz"],"":0,"a/b":1,"c%d":2,"e^f":3,"g|h":4,"i\\j":5,"k\"l":6," ":7,"m~n":8})");
+    CHECK(lookup(example, "") == example.toJsonString());
+    CHECK(lookup(example, "/foo") == "[\"bar\",\"baz\"]");
+    CHECK(lookup(example, "/foo/0") == "\"bar\"");
+    CHECK(lookup(example, "/") == "0");
+    CHECK(lookup(example, "/a~1b") == "1");
+    CHECK(lookup(example, "/c%d") == "2");
+    CHECK(lookup(example, "/e^f") == "3");
+    CHECK(lookup(example, "/g|h") == "4");
+    CHECK(lookup(example, "/i\\j") == "5");
+    CHECK(lookup(example, "/k\"l") == "6");
+    CHECK(lookup(example, "/ ") == "7");
+    CHECK(lookup(example, "/m~0n") == "8");
+
+    // a tilde is unescaped before a slash is, so "~01" is "~1" and not a slash
+    Value tricky = Value::fromJson(R"({"~1":"tilde","/":"slash"})");
+    CHECK(lookup(tricky, "/~01") == "\"tilde\"");
+    CHECK(lookup(tricky, "/~1") == "\"slash\"");
+
+    // dotted paths and indices between brackets
+    Value document = Value::fromJson(R"({"order":{"items":[{"sku":"a"},{"sku":"b"}],"0":"zero"},"list":[[1,2],[3]]})");
+    CHECK(lookup(document, "order.items[1].sku") == "\"b\"");
+    CHECK(lookup(document, "order.items.0.sku") == "\"a\"");
+    CHECK(lookup(document, "list[1][0]") == "3");
+    CHECK(lookup(Value::fromJson("[[1,2]]"), "[0][1]") == "2");
+
+    // numbers are keys in maps, unless they are between brackets
+    CHECK(lookup(document, "order.0") == "\"zero\"");
+    CHECK(lookup(document, "/order/0") == "\"zero\"");
+    CHECK(lookup(document, "order[0]") == "missing");
+
+    // paths that do not lead anywhere
+    CHECK(lookup(document, "order.missing") == "missing");
+    CHECK(lookup(document, "order.items[2]") == "missing");
+    CHECK(lookup(document, "order.items.sku") == "missing");
+    CHECK(lookup(document, "order.items[0].sku.more") == "missing");
+    CHECK(lookup(document, "list[0][1][0]") == "missing");
+    CHECK(lookup(document, "/list/-") == "missing");
+    CHECK(lookup(document, "/list/01") == "missing");
+    CHECK(lookup(document, "/list/99999999999999999999") == "missing");
+    CHECK(lookup(Value(), "a") == "missing");
+
+    // errors in json pointers
+    CHECK(fails("/a~2", 2, "invalid escape sequence"));
+    CHECK(fails("/a~", 2, "invalid escape sequence"));
+
+    // errors in dotted paths
+    CHECK(fails("a..b", 2, "empty key"));
+    CHECK(fails("a.", 2, "empty key"));
+    CHECK(fails(".a", 0, "empty key"));
+    CHECK(fails("a.[0]", 2, "empty key"));
+    CHECK(fails("a[0", 1, "unterminated index"));
+    CHECK(fails("a[]", 2, "invalid index"));
+    CHECK(fails("a[01]", 2, "invalid index"));
+    CHECK(fails("a[-]", 2, "invalid index"));
+    CHECK(fails("a[x]", 2, "invalid index"));
+    CHECK(fails("a[0]b", 4, "expected '.' or '['"));
+
+    // an invalid path finds nothing, and writes nowhere
+    ValuePath invalid("a..b");
+    CHECK(!invalid && invalid.find(document) == nullptr);
+    Value untouched = document;
+    invalid.resolveOrCreate(untouched) = 1;
+    CHECK(untouched == document);
+
+    // missing members are added, with maps for keys and vectors for indices
+    Value created;
+    ValuePath("order.items[0].sku").resolveOrCreate(created) = "a";
+    CHECK(created.toJsonString() == R"({"order":{"items":[{"sku":"a"}]}})");
+    ValuePath("/order/items/-/sku").resolveOrCreate(created) = "b";
+    ValuePath("order.items[2]").resolveOrCreate(created) = 3;
+    CHECK(created.toJsonString() == R"({"order":{"items":[{"sku":"a"},{"sku":"b"},3]}})");
+
+    // numbers add keys when the value is not a vector yet, and the values in the way are replaced
+    ValuePath("/order/0").resolveOrCreate(created) = true;
+    ValuePath("order.items[2].x").resolveOrCreate(created) = 1;
+    CHECK(created.toJsonString() == R"({"order":{"items":[{"sku":"a"},{"sku":"b"},{"x":1}],"0":true}})");
+    ValuePath("count.0").resolveOrCreate(created) = 1;
+    CHECK(lookup(created, "count") == R"({"0":1})");
+
+    // existing values are found without being changed
+    ValuePath sku("order.items[1].sku");
+    CHECK(&sku.resolveOrCreate(created) == sku.find(created));
+    CHECK(created.toJsonString() == R"({"order":{"items":[{"sku":"a"},{"sku":"b"},{"x":1}],"0":true},"count":{"0":1}})");
+
+    // an index beyond the end writes nowhere, but the steps before it are added
+    Value gap;
+    ValuePath("list[1]").resolveOrCreate(gap) = 1;
+    CHECK(gap.toJsonString() == R"({"list":null})");
+
+    // a copy of the document is not modified
+    Value copy = created;
+    ValuePath("order.items[0].sku").resolveOrCreate(created) = "changed";
+    CHECK(lookup(copy, "order.items[0].sku") == "\"a\"");
+    CHECK(lookup(created, "order.items[0].sku") == "\"changed\"");
+
+    // done
+    return report("ValuePath");
+}
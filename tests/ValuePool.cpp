@@ -0,0 +1,147 @@
+/**
+ *  ValuePool.cpp
+ *
+ *  Values that are created by one thread and destructed by another,
+ *  also after the thread that created them has exited. The memory of
+ *  such values goes back to the pool it came from, so the pools stop
+ *  growing once they are big enough.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include "../include/Value.h"
+#include "Check.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Variant;
+
+/**
+ *  The number of chunks the pools allocated, which are the only aligned allocations
+ */
+static std::atomic<size_t> chunks{0};
+
+/**
+ *  Count the aligned allocations
+ */
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    ++chunks;
+    void *result = std::aligned_alloc((size_t)alignment, size);
+    if (result == nullptr) throw std::bad_alloc();
+    return result;
+}
+void operator delete(void *pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+/**
+ *  Create values, with a string that fits in the value
+ *  @param  count
+ *  @param  round
+ *  @return std::vector<Value>
+ */
+static std::vector<Value> create(size_t count, size_t round)
+{
+    std::vector<Value> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) result.emplace_back(std::to_string(round) + ":" + std::to_string(i));
+    return result;
+}
+
+/**
+ *  Are the values the ones that were created?
+ *  @param  values
+ *  @param  round
+ *  @return bool
+ */
+static bool intact(const std::vector<Value>& values, size_t round)
+{
+    for (size_t i = 0; i < values.size(); ++i) if (values[i].view() != std::to_string(round) + ":" + std::to_string(i)) return false;
+    return true;
+}
+
+/**
+ *  Main procedure
+ */
+int main()
+{
+    // the number of values per round
+    const size_t count = 10000;
+
+    // values created here and destructed by another thread go back to our pool, and are used again
+    size_t after = 0;
+    for (size_t round = 0; round < 20; ++round)
+    {
+        std::vector<Value> values = create(count, round);
+        std::thread thread([&values, round]() {
+            CHECK(intact(values, round));
+            values.clear();
+        });
+        thread.join();
+
+        // the first round fills the pool
+        if (round == 0) after = chunks;
+    }
+    CHECK(after > 0 && chunks == after);
+
+    // values that outlive the thread that created them
+    for (size_t round = 0; round < 20; ++round)
+    {
+        std::vector<Value> values;
+        std::thread thread([&values, round]() { values = create(count, round); });
+        thread.join();
+        CHECK(intact(values, round));
+    }
+
+    // the pools of the exited threads are used again by new threads
+    after = chunks;
+    for (size_t round = 0; round < 20; ++round)
+    {
+        std::vector<Value> values;
+        std::thread thread([&values, round]() { values = create(count, round); });
+        thread.join();
+        values.clear();
+    }
+    CHECK(chunks == after);
+
+    // threads that create values and destruct the values of the others at the same time
+    const size_t threads = 4;
+    std::vector<std::vector<Value>> slots(threads);
+    std::atomic<size_t> arrived{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) workers.emplace_back([&, t]() {
+        for (size_t round = 0; round < 50; ++round)
+        {
+            // fill our own slot, and wait for the others to do the same
+            slots[t] = create(1000, round * threads + t);
+            for (++arrived; arrived < (round + 1) * threads * 2 - threads;) std::this_thread::yield();
+
+            // drop the values of the next thread, and wait until everybody is done
+            size_t next = (t + 1) % threads;
+            CHECK(intact(slots[next], round * threads + next));
+            slots[next].clear();
+            for (++arrived; arrived < (round + 1) * threads * 2;) std::this_thread::yield();
+        }
+    });
+    for (auto &worker : workers) worker.join();
+
+    // a value that is shared by threads that drop their copies at the same time
+    Value shared = create(1, 0)[0];
+    std::vector<std::thread> droppers;
+    for (size_t t = 0; t < threads; ++t) droppers.emplace_back([copies = std::vector<Value>(1000, shared)]() mutable { copies.clear(); });
+    for (auto &dropper : droppers) dropper.join();
+    CHECK(shared.view() == "0:0");
+
+    // done
+    return report("ValuePool");
+}
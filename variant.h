@@ -22,3 +22,9 @@
  */
 #include <variant/Value.h>
 #include <variant/ValueMember.h>
+#include <variant/ValueIterator.h>
+#include <variant/ValuePath.h>
+#include <variant/ValueArena.h>
+#include <variant/KeyTable.h>
+#include <variant/JsonHandler.h>
+#include <variant/JsonStream.h>